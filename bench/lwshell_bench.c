@@ -0,0 +1,230 @@
+/**
+ * \file            lwshell_bench.c
+ * \brief           LwSHELL micro-benchmark suite
+ *
+ * Every measurement is printed as a single JSON object per line (JSON lines),
+ * to allow simple tracking of regressions between builds.
+ *
+ * Usage: lwshell_bench [scale]
+ *
+ * Optional `scale` parameter multiplies default number of iterations
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lwshell/lwshell.h"
+
+/* Default number of lines processed per measurement */
+#define BENCH_DEF_LINES 100000UL
+
+/* Output statistics */
+static size_t out_calls, out_bytes;
+
+/* Sink to prevent compiler to optimize command calls away */
+static volatile int32_t cmd_sink;
+
+/* Command names for dispatch benchmark */
+static char cmd_names[LWSHELL_CFG_MAX_DYNAMIC_CMDS][8];
+
+/* Number of lines per measurement */
+static unsigned long bench_lines = BENCH_DEF_LINES;
+
+/**
+ * \brief           Get current time in units of seconds
+ * \return          Monotonic-like time in seconds
+ */
+static double
+prv_now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief           Output function, counting calls and bytes only
+ * \param[in]       str: String to print, null-terminated
+ * \param[in]       lw: LwSHELL instance
+ */
+static void
+prv_output(const char* str, lwshell_t* lw) {
+    (void)lw;
+    ++out_calls;
+    out_bytes += strlen(str);
+}
+
+/**
+ * \brief           Command doing no real work
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ * \return          `0` on success
+ */
+static int32_t
+prv_nop_cmd(int32_t argc, char** argv) {
+    cmd_sink += argc + (int32_t)argv[argc - 1][0];
+    return 0;
+}
+
+/**
+ * \brief           Initialize default shell instance with `cmds_cnt` commands
+ * \param[in]       cmds_cnt: Number of commands to register
+ * \param[in]       use_output: Set to `1` to enable output function
+ */
+static void
+prv_shell_setup(size_t cmds_cnt, uint8_t use_output) {
+    lwshell_init();
+    lwshell_set_output_fn(use_output ? prv_output : NULL);
+    for (size_t idx = 0; idx < cmds_cnt; ++idx) {
+        sprintf(cmd_names[idx], "cmd%03u", (unsigned)idx);
+        lwshell_register_cmd(cmd_names[idx], prv_nop_cmd, NULL);
+    }
+    out_calls = 0;
+    out_bytes = 0;
+}
+
+/**
+ * \brief           Feed single line `bench_lines` times to the shell and measure time
+ * \param[in]       line: Line to input, including line terminator
+ * \return          Elapsed time in units of seconds
+ */
+static double
+prv_run_lines(const char* line) {
+    size_t len = strlen(line);
+    double start;
+
+    start = prv_now();
+    for (unsigned long i = 0; i < bench_lines; ++i) {
+        lwshell_input(line, len);
+    }
+    return prv_now() - start;
+}
+
+/**
+ * \brief           Input throughput, processed as one line at a time
+ */
+static void
+prv_bench_input(void) {
+    static const struct {
+        const char* name;
+        const char* line;
+    } cases[] = {
+        {"short", "cmd000\n"},
+        {"typical", "cmd000 1 2 param3\n"},
+        {"long", "cmd000 0123456789 0123456789 0123456789 0123456789 0123456789 0123456789\n"},
+    };
+
+    for (size_t idx = 0; idx < LWSHELL_ARRAYSIZE(cases); ++idx) {
+        size_t len = strlen(cases[idx].line);
+        double elapsed;
+
+        prv_shell_setup(1, 0);
+        elapsed = prv_run_lines(cases[idx].line);
+        printf("{\"bench\":\"input\",\"case\":\"%s\",\"line_len\":%u,\"lines\":%lu,"
+               "\"seconds\":%.6f,\"bytes_per_s\":%.0f,\"lines_per_s\":%.0f}\n",
+               cases[idx].name, (unsigned)len, bench_lines, elapsed, (double)len * bench_lines / elapsed,
+               bench_lines / elapsed);
+    }
+}
+
+/**
+ * \brief           Dispatch latency versus number of registered commands.
+ *
+ * Last registered command is always called, to measure worst case lookup
+ */
+static void
+prv_bench_dispatch(void) {
+    static const size_t counts[] = {1, 4, 16, 64, 256};
+
+    for (size_t idx = 0; idx < LWSHELL_ARRAYSIZE(counts); ++idx) {
+        char line[16];
+        double elapsed;
+
+        if (counts[idx] > LWSHELL_CFG_MAX_DYNAMIC_CMDS) {
+            break;
+        }
+        prv_shell_setup(counts[idx], 0);
+        sprintf(line, "%s\n", cmd_names[counts[idx] - 1]);
+        elapsed = prv_run_lines(line);
+        printf("{\"bench\":\"dispatch\",\"cmds\":%u,\"lines\":%lu,\"seconds\":%.6f,\"ns_per_line\":%.1f}\n",
+               (unsigned)counts[idx], bench_lines, elapsed, elapsed * 1e9 / bench_lines);
+    }
+}
+
+/**
+ * \brief           Tokenizer cost versus number of arguments and quoting style
+ */
+static void
+prv_bench_tokenizer(void) {
+    static const char* styles[] = {"plain", "quoted", "escaped"};
+    static const char* args[] = {" arg_0001", " \"arg 0001\"", " \"a\\\"g 0001\""};
+
+    for (size_t style = 0; style < LWSHELL_ARRAYSIZE(styles); ++style) {
+        for (size_t argc = 0; argc < LWSHELL_CFG_MAX_CMD_ARGS; argc = argc * 2 + 1) {
+            char line[LWSHELL_CFG_MAX_INPUT_LEN + 2];
+            double elapsed;
+
+            strcpy(line, "cmd000");
+            for (size_t i = 0; i < argc; ++i) {
+                strcat(line, args[style]);
+            }
+            strcat(line, "\n");
+            if (strlen(line) > LWSHELL_CFG_MAX_INPUT_LEN) {
+                break;
+            }
+
+            prv_shell_setup(1, 0);
+            elapsed = prv_run_lines(line);
+            printf("{\"bench\":\"tokenizer\",\"style\":\"%s\",\"args\":%u,\"line_len\":%u,\"lines\":%lu,"
+                   "\"seconds\":%.6f,\"ns_per_line\":%.1f}\n",
+                   styles[style], (unsigned)argc, (unsigned)strlen(line), bench_lines, elapsed,
+                   elapsed * 1e9 / bench_lines);
+        }
+    }
+}
+
+/**
+ * \brief           Number of output function calls and output bytes per input line
+ */
+static void
+prv_bench_output(void) {
+    static const struct {
+        const char* name;
+        const char* line;
+    } cases[] = {
+        {"known_lf", "cmd000 1 2\n"},
+        {"known_crlf", "cmd000 1 2\r\n"},
+        {"unknown_lf", "unknown 1 2\n"},
+        {"help_lf", "cmd000 -h\n"},
+        {"backspace_lf", "cmd000 1 2x\b\n"},
+    };
+
+    for (size_t idx = 0; idx < LWSHELL_ARRAYSIZE(cases); ++idx) {
+        size_t len = strlen(cases[idx].line);
+        double elapsed;
+
+        prv_shell_setup(1, 1);
+        elapsed = prv_run_lines(cases[idx].line);
+        printf("{\"bench\":\"output\",\"case\":\"%s\",\"line_len\":%u,\"lines\":%lu,\"seconds\":%.6f,"
+               "\"calls_per_line\":%.2f,\"bytes_per_line\":%.2f}\n",
+               cases[idx].name, (unsigned)len, bench_lines, elapsed, (double)out_calls / bench_lines,
+               (double)out_bytes / bench_lines);
+    }
+}
+
+/* Program entry point */
+int
+main(int argc, char** argv) {
+    if (argc > 1) {
+        unsigned long scale = strtoul(argv[1], NULL, 10);
+        if (scale > 0) {
+            bench_lines = BENCH_DEF_LINES * scale;
+        }
+    }
+
+    prv_bench_input();
+    prv_bench_dispatch();
+    prv_bench_tokenizer();
+    prv_bench_output();
+    return 0;
+}
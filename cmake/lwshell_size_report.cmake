@@ -0,0 +1,62 @@
+#
+# Print memory footprint of lwshell library built with different configurations
+#
+# Script is executed in script mode (cmake -P) and expects following variables:
+#
+# LWSHELL_SIZE_TOOL: Path to the "size" binary utility
+# LWSHELL_NM_TOOL: Path to the "nm" binary utility
+# LWSHELL_SIZE_NAMES: Comma separated list of configuration names
+# LWSHELL_SIZE_OBJECTS: Comma separated list of object files, one for each name
+#
+# sizeof(lwshell_t) is read as size of the default instance object in the library
+#
+
+string(REPLACE "," ";" names "${LWSHELL_SIZE_NAMES}")
+string(REPLACE "," ";" objects "${LWSHELL_SIZE_OBJECTS}")
+list(LENGTH names names_len)
+math(EXPR names_last "${names_len} - 1")
+
+# Left-align text to fixed width
+function(lwshell_pad out str width)
+    string(LENGTH "${str}" len)
+    while(len LESS width)
+        string(APPEND str " ")
+        math(EXPR len "${len} + 1")
+    endwhile()
+    set(${out} "${str}" PARENT_SCOPE)
+endfunction()
+
+lwshell_pad(line "config" 28)
+message("${line}    text    data     bss  sizeof(lwshell_t)")
+foreach(idx RANGE ${names_last})
+    list(GET names ${idx} name)
+    list(GET objects ${idx} obj)
+
+    # Berkeley format, second line holds text, data, bss, dec, hex values
+    execute_process(COMMAND ${LWSHELL_SIZE_TOOL} ${obj} OUTPUT_VARIABLE size_out RESULT_VARIABLE res)
+    if(NOT res EQUAL 0)
+        message(FATAL_ERROR "Cannot read size of ${obj}")
+    endif()
+    string(REGEX MATCH "\n[ \t]*([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)" size_line "${size_out}")
+    set(text ${CMAKE_MATCH_1})
+    set(data ${CMAKE_MATCH_2})
+    set(bss ${CMAKE_MATCH_3})
+
+    # Symbol size of the default instance
+    execute_process(COMMAND ${LWSHELL_NM_TOOL} -S ${obj} OUTPUT_VARIABLE nm_out)
+    set(inst_size "?")
+    if(nm_out MATCHES "[0-9a-fA-F]+ ([0-9a-fA-F]+) [bBdD] shell\n")
+        math(EXPR inst_size "0x${CMAKE_MATCH_1}" OUTPUT_FORMAT DECIMAL)
+    endif()
+
+    lwshell_pad(line "${name}" 28)
+    foreach(val ${text} ${data} ${bss})
+        string(LENGTH "${val}" len)
+        while(len LESS 8)
+            string(PREPEND val " ")
+            math(EXPR len "${len} + 1")
+        endwhile()
+        string(APPEND line "${val}")
+    endforeach()
+    message("${line}  ${inst_size}")
+endforeach()
@@ -36,11 +36,26 @@
 
 /* Rename this file to "lwshell_opts.h" for your application */
 
+#ifdef _WIN32
 #include "windows.h"
+#endif /* _WIN32 */
 
 #define LWSHELL_CFG_USE_OUTPUT           1
 #define LWSHELL_CFG_USE_LIST_CMD         1
 #define LWSHELL_CFG_USE_DYNAMIC_COMMANDS 1
 #define LWSHELL_CFG_USE_STATIC_COMMANDS  1
+#define LWSHELL_CFG_USE_PAYLOAD          1
+#define LWSHELL_CFG_USE_VARS             1
+#define LWSHELL_CFG_USE_ALIAS            1
+#define LWSHELL_CFG_USE_PRINTF           1
+#define LWSHELL_CFG_PRINTF_FLOAT         1
+#define LWSHELL_CFG_USE_STRUCTURED_OUTPUT 1
+#define LWSHELL_CFG_USE_RESULT           1
+#define LWSHELL_CFG_USE_PERMISSIONS      1
+#define LWSHELL_CFG_USE_TRANSCRIPT       1
+#define LWSHELL_CFG_USE_RATE_LIMIT       1
+#define LWSHELL_CFG_USE_LINE_COALESCE    1
+#define LWSHELL_CFG_USE_ECHO_MODE        1
+#define LWSHELL_CFG_RATE_QUEUE_SIZE      256
 
 #endif /* LWSHELL_HDR_OPTS_H */
@@ -2,6 +2,7 @@
 #include "lwshell/lwshell.h"
 #include <string.h>
 #include <stdint.h>
+#include <time.h>
 
 /**
  * \brief           Reading one character at a time 
@@ -30,13 +31,93 @@ static void
 shell_output(const char* str, lwshell_t* lw) {
     (void)lw;
     printf("%s", str);
-    if (*str == '\r') {
+    if (str[0] == '\r' && str[1] == '\0') {
         printf("\n");
     }
 }
 
 #endif /* LWSHELL_CFG_USE_OUTPUT */
 
+#if LWSHELL_CFG_USE_TRANSCRIPT || LWSHELL_CFG_USE_RATE_LIMIT
+
+/**
+ * \brief           Time function for transcript timestamps and rate limits
+ * \param[in]       lw: LwSHELL instance
+ * \return          Current time in units of milliseconds
+ */
+static uint32_t
+shell_time(lwshell_t* lw) {
+    struct timespec ts;
+    (void)lw;
+    timespec_get(&ts, TIME_UTC);
+    return (uint32_t)((unsigned long long)ts.tv_sec * 1000U + (unsigned long long)ts.tv_nsec / 1000000U);
+}
+
+#endif /* LWSHELL_CFG_USE_TRANSCRIPT || LWSHELL_CFG_USE_RATE_LIMIT */
+
+#if LWSHELL_CFG_USE_TRANSCRIPT
+
+/* Transcript output file */
+static FILE* transcript_file;
+
+/**
+ * \brief           Transcript function, writing recording to file
+ * \param[in]       lw: LwSHELL instance
+ * \param[in]       data: Transcript data
+ * \param[in]       len: Length of data in bytes
+ */
+static void
+shell_transcript(lwshell_t* lw, const void* data, size_t len) {
+    (void)lw;
+    fwrite(data, 1, len, transcript_file);
+    fflush(transcript_file);
+}
+
+#endif /* LWSHELL_CFG_USE_TRANSCRIPT */
+
+#if LWSHELL_CFG_USE_RESULT
+
+/**
+ * \brief           Result function, reporting failed commands
+ * \param[in]       result: Result of processed line
+ * \param[in]       lw: LwSHELL instance
+ */
+static void
+shell_result(const lwshell_result_t* result, lwshell_t* lw) {
+    if (result->status == lwshellSTATUS_OK && result->ret != 0) {
+        lwshell_printf_ex(lw, "Command failed with code %ld" LWSHELL_CFG_NEWLINE, (long)result->ret);
+    }
+    if (result->flags & LWSHELL_RESULT_FLAG_TOO_MANY_ARGS) {
+        lwshell_printf_ex(lw, "Too many arguments, extra ignored" LWSHELL_CFG_NEWLINE);
+    }
+}
+
+#endif /* LWSHELL_CFG_USE_RESULT */
+
+#if LWSHELL_CFG_USE_PERMISSIONS
+
+/* Permission to run administrative commands */
+#define SHELL_PERM_ADMIN 0x01
+
+/**
+ * \brief           Login function, grants admin permissions with `login admin`
+ * \param[in]       lw: LwSHELL instance
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ * \return          Granted permission mask
+ */
+static lwshell_perm_t
+shell_login(lwshell_t* lw, int32_t argc, char** argv) {
+    if (argc == 2 && strcmp(argv[1], "admin") == 0) {
+        lwshell_printf_ex(lw, "Logged in" LWSHELL_CFG_NEWLINE);
+        return SHELL_PERM_ADMIN;
+    }
+    lwshell_printf_ex(lw, "Logged out" LWSHELL_CFG_NEWLINE);
+    return 0;
+}
+
+#endif /* LWSHELL_CFG_USE_PERMISSIONS */
+
 /* Commands ... */
 
 int32_t
@@ -48,7 +129,7 @@ addint_cmd(int32_t argc, char** argv) {
     i1 = lwshell_parse_long_long(argv[1]);
     i2 = lwshell_parse_long_long(argv[2]);
 
-    printf("%lld\r\n", (i1 + i2));
+    lwshell_printf("%lld\r\n", (i1 + i2));
     return 0;
 }
 
@@ -61,7 +142,7 @@ subint_cmd(int32_t argc, char** argv) {
     i1 = lwshell_parse_long_long(argv[1]);
     i2 = lwshell_parse_long_long(argv[2]);
 
-    printf("%lld\r\n", (i1 - i2));
+    lwshell_printf("%lld\r\n", (i1 - i2));
     return 0;
 }
 
@@ -74,7 +155,7 @@ adddbl_cmd(int32_t argc, char** argv) {
     i1 = lwshell_parse_double(argv[1]);
     i2 = lwshell_parse_double(argv[2]);
 
-    printf("%f\r\n", (i1 + i2));
+    lwshell_printf("%f\r\n", (i1 + i2));
     return 0;
 }
 
@@ -87,33 +168,97 @@ subdbl_cmd(int32_t argc, char** argv) {
     i1 = lwshell_parse_double(argv[1]);
     i2 = lwshell_parse_double(argv[2]);
 
-    printf("%f\r\n", (i1 - i2));
+    lwshell_printf("%f\r\n", (i1 - i2));
+    return 0;
+}
+
+#if LWSHELL_CFG_USE_STRUCTURED_OUTPUT
+
+int32_t
+status_cmd(int32_t argc, char** argv) {
+    (void)argv;
+    lwshell_emit_begin();
+    lwshell_emit_str("name", "lwshell-dev");
+    lwshell_emit_int("args", argc);
+    lwshell_emit_bool("ok", 1);
+    lwshell_emit_end();
+    return 0;
+}
+
+int32_t
+mode_cmd(int32_t argc, char** argv) {
+    if (argc < 2) {
+        return -1;
+    }
+    lwshell_set_output_mode(strcmp(argv[1], "json") == 0 ? LWSHELL_OUTPUT_MODE_JSON : LWSHELL_OUTPUT_MODE_HUMAN);
+    return 0;
+}
+
+#endif /* LWSHELL_CFG_USE_STRUCTURED_OUTPUT */
+
+#if LWSHELL_CFG_USE_ECHO_MODE
+
+int32_t
+echo_cmd(int32_t argc, char** argv) {
+    static const char* modes[] = {"on", "mask", "off", "raw"};
+
+    for (size_t idx = 0; argc > 1 && idx < LWSHELL_ARRAYSIZE(modes); ++idx) {
+        if (strcmp(argv[1], modes[idx]) == 0) {
+            lwshell_set_echo_mode((lwshell_echo_mode_t)idx);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+#endif /* LWSHELL_CFG_USE_ECHO_MODE */
+
+#if LWSHELL_CFG_USE_PAYLOAD
+
+static size_t upload_len;
+
+/* Payload receive function, called for every received chunk */
+void
+upload_payload_fn(lwshell_t* lw, const char* data, size_t len) {
+    (void)lw;
+    (void)data;
+    upload_len += len;
+}
+
+int32_t
+upload_cmd(int32_t argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    lwshell_printf("Received %u bytes of payload\r\n", (unsigned)upload_len);
+    upload_len = 0;
     return 0;
 }
 
+#endif /* LWSHELL_CFG_USE_PAYLOAD */
+
 #if LWSHELL_CFG_USE_STATIC_COMMANDS
 
 int32_t
 addintstatic_cmd(int32_t argc, char** argv) {
-    printf("Static command...\r\n");
+    lwshell_printf("Static command...\r\n");
     return addint_cmd(argc, argv);
 }
 
 int32_t
 subintstatic_cmd(int32_t argc, char** argv) {
-    printf("Static command...\r\n");
+    lwshell_printf("Static command...\r\n");
     return subint_cmd(argc, argv);
 }
 
 int32_t
 adddblstatic_cmd(int32_t argc, char** argv) {
-    printf("Static command...\r\n");
+    lwshell_printf("Static command...\r\n");
     return adddbl_cmd(argc, argv);
 }
 
 int32_t
 subdblstatic_cmd(int32_t argc, char** argv) {
-    printf("Static command...\r\n");
+    lwshell_printf("Static command...\r\n");
     return subdbl_cmd(argc, argv);
 }
 
@@ -131,21 +276,59 @@ static const lwshell_cmd_t static_cmds[] = {
 
 /* Program entry point */
 int
-main(void) {
+main(int argc, char** argv) {
     /* Init library */
     lwshell_init();
 
+#if LWSHELL_CFG_USE_TRANSCRIPT
+    /* Record session to file given as first parameter, replay it with lwshell_replay tool */
+    if (argc > 1 && (transcript_file = fopen(argv[1], "wb")) != NULL) {
+        lwshell_set_time_fn(shell_time);
+        lwshell_set_transcript_fn(shell_transcript);
+    }
+#else
+    (void)argc;
+    (void)argv;
+#endif /* LWSHELL_CFG_USE_TRANSCRIPT */
+
+#if LWSHELL_CFG_USE_RATE_LIMIT
+    /* Execute at most 10 commands per second, pasted input waits in the queue */
+    lwshell_set_time_fn(shell_time);
+    lwshell_set_rate_limit(0, 10);
+#endif /* LWSHELL_CFG_USE_RATE_LIMIT */
+
 #if LWSHELL_CFG_USE_OUTPUT
     /* Add optional output function for the purpose of the feedback */
     lwshell_set_output_fn(shell_output);
 #endif /* LWSHELL_CFG_USE_OUTPUT */
 
+#if LWSHELL_CFG_USE_RESULT
+    /* Get notified about command return values */
+    lwshell_set_result_fn(shell_result);
+#endif /* LWSHELL_CFG_USE_RESULT */
+
 #if LWSHELL_CFG_USE_DYNAMIC_COMMANDS
     /* Define shell commands */
     lwshell_register_cmd("addint", addint_cmd, "Adds 2 integer numbers and prints them");
     lwshell_register_cmd("subint", subint_cmd, "Substitute 2 integer numbers and prints them");
     lwshell_register_cmd("adddbl", adddbl_cmd, "Adds 2 double numbers and prints them");
     lwshell_register_cmd("subdbl", subdbl_cmd, "Substitute 2 double numbers and prints them");
+#if LWSHELL_CFG_USE_STRUCTURED_OUTPUT
+    lwshell_register_cmd("status", status_cmd, "Prints status record");
+    lwshell_register_cmd("mode", mode_cmd, "Sets output mode, \"json\" or \"human\"");
+#endif /* LWSHELL_CFG_USE_STRUCTURED_OUTPUT */
+#if LWSHELL_CFG_USE_ECHO_MODE
+    lwshell_register_cmd("echo", echo_cmd, "Sets echo mode, \"on\", \"mask\", \"off\" or \"raw\"");
+#endif /* LWSHELL_CFG_USE_ECHO_MODE */
+#if LWSHELL_CFG_USE_PAYLOAD
+    lwshell_register_payload_cmd("upload", upload_cmd, upload_payload_fn,
+                                 "Receives streaming payload until end of line");
+#endif /* LWSHELL_CFG_USE_PAYLOAD */
+#if LWSHELL_CFG_USE_PERMISSIONS
+    /* Payload upload is available only after `login admin` */
+    lwshell_set_login_fn(shell_login);
+    lwshell_set_cmd_perm("upload", SHELL_PERM_ADMIN);
+#endif /* LWSHELL_CFG_USE_PERMISSIONS */
 #endif /* LWSHELL_CFG_USE_DYNAMIC_COMMANDS */
 
 #if LWSHELL_CFG_USE_STATIC_COMMANDS
@@ -167,6 +350,10 @@ main(void) {
 
         /* Insert input to library */
         lwshell_input(str, strlen(str));
+#if LWSHELL_CFG_USE_RATE_LIMIT
+        /* Process input queued due to rate limits */
+        lwshell_process();
+#endif /* LWSHELL_CFG_USE_RATE_LIMIT */
     }
     return 0;
 }
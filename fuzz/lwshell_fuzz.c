@@ -0,0 +1,441 @@
+/**
+ * \file            lwshell_fuzz.c
+ * \brief           LwSHELL fuzzing and differential test harness
+ *
+ * Harness feeds arbitrary byte streams to \ref lwshell_input_ex and compares
+ * complete transcript (echo, library output and executed commands with arguments)
+ * with the one produced by the reference model of the input state machine and tokenizer.
+ *
+ * Build modes:
+ *  - `LWSHELL_FUZZ_LIBFUZZER` defined: libFuzzer entry point only
+ *  - Otherwise standalone executable:
+ *      - `lwshell_fuzz` reads single input from `stdin` (AFL compatible)
+ *      - `lwshell_fuzz file [file...]` runs every file as single input (AFL `@@` compatible)
+ *      - `lwshell_fuzz -r [iterations] [seed]` runs random differential mode
+ *
+ * With `LWSHELL_FUZZ_ALLOC_FAIL` defined, allocator fails on purpose
+ * and only crashes and sanitizer errors are detected
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lwshell/lwshell.h"
+
+/* Maximum input length processed in single run */
+#define FUZZ_MAX_INPUT_LEN 8192
+
+/* Transcript buffer size, must hold worst-case output for maximum input */
+#define FUZZ_TRANSCRIPT_LEN (1024UL * 1024UL)
+
+/* Markers to separate command execution records in transcript */
+#define FUZZ_MARK_CMD       '\x01'
+#define FUZZ_MARK_ARG       '\x02'
+
+/**
+ * \brief           Transcript of single run
+ */
+typedef struct {
+    char data[FUZZ_TRANSCRIPT_LEN]; /*!< Transcript data */
+    size_t len;                     /*!< Number of valid bytes */
+    uint8_t overflow;               /*!< Set to `1` when data did not fit */
+} fuzz_transcript_t;
+
+/* Command names registered to library and known to reference model */
+static const char* cmd_names[] = {"a", "ab", "cmd", "-h"};
+
+/* Command descriptions, `NULL` tests missing description path */
+static const char* cmd_descs[] = {"desc a", NULL, "cmd help", "dash"};
+
+/* Transcripts to compare */
+static fuzz_transcript_t tr_lib, tr_lib_chunked, tr_ref;
+
+/* Currently active transcript for library callbacks */
+static fuzz_transcript_t* tr_active;
+
+#if LWSHELL_FUZZ_ALLOC_FAIL
+
+/* Allocator state, seeded for every run */
+static uint32_t alloc_state;
+
+/**
+ * \brief           Allocator failing pseudo-randomly, roughly every fourth call
+ * \param[in]       ptr: Memory to reallocate, `NULL` to allocate new memory
+ * \param[in]       size: New size in bytes
+ * \return          Pointer to memory on success, `NULL` otherwise
+ */
+void*
+fuzz_realloc(void* ptr, size_t size) {
+    alloc_state = alloc_state * 1103515245UL + 12345UL;
+    if (((alloc_state >> 16) & 0x03U) == 0) {
+        return NULL;
+    }
+    return realloc(ptr, size);
+}
+
+#endif /* LWSHELL_FUZZ_ALLOC_FAIL */
+
+/**
+ * \brief           Append data to transcript
+ * \param[in]       tr: Transcript
+ * \param[in]       data: Data to append
+ * \param[in]       len: Data length
+ */
+static void
+prv_tr_append(fuzz_transcript_t* tr, const char* data, size_t len) {
+    if (tr->len + len > sizeof(tr->data)) {
+        tr->overflow = 1;
+        return;
+    }
+    memcpy(&tr->data[tr->len], data, len);
+    tr->len += len;
+}
+
+/**
+ * \brief           Append command execution record to transcript
+ * \param[in]       tr: Transcript
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Arguments
+ */
+static void
+prv_tr_append_cmd(fuzz_transcript_t* tr, int32_t argc, char** argv) {
+    char ch = FUZZ_MARK_CMD;
+
+    prv_tr_append(tr, &ch, 1);
+    ch = FUZZ_MARK_ARG;
+    for (int32_t i = 0; i < argc; ++i) {
+        prv_tr_append(tr, argv[i], strlen(argv[i]));
+        prv_tr_append(tr, &ch, 1);
+    }
+}
+
+/**
+ * \brief           Library output function
+ * \param[in]       str: String to print, null-terminated
+ * \param[in]       lw: LwSHELL instance
+ */
+static void
+prv_lib_output(const char* str, lwshell_t* lw) {
+    (void)lw;
+    prv_tr_append(tr_active, str, strlen(str));
+}
+
+/**
+ * \brief           Library command, records its arguments
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ * \return          `0` on success
+ */
+static int32_t
+prv_lib_cmd(int32_t argc, char** argv) {
+    prv_tr_append_cmd(tr_active, argc, argv);
+    return 0;
+}
+
+/**
+ * \brief           Run library on input data
+ * \param[in]       tr: Transcript to fill
+ * \param[in]       data: Input data
+ * \param[in]       len: Input data length
+ * \param[in]       chunk: Maximum chunk size to pass to \ref lwshell_input_ex at a time
+ */
+static void
+prv_run_lib(fuzz_transcript_t* tr, const uint8_t* data, size_t len, size_t chunk) {
+    tr->len = 0;
+    tr->overflow = 0;
+    tr_active = tr;
+#if LWSHELL_FUZZ_ALLOC_FAIL
+    alloc_state = (uint32_t)len * 31U + (uint32_t)chunk;
+#endif /* LWSHELL_FUZZ_ALLOC_FAIL */
+
+    lwshell_init();
+    lwshell_set_output_fn(prv_lib_output);
+    for (size_t idx = 0; idx < LWSHELL_ARRAYSIZE(cmd_names); ++idx) {
+        lwshell_register_cmd(cmd_names[idx], prv_lib_cmd, cmd_descs[idx]);
+    }
+    for (size_t idx = 0; idx < len; idx += chunk) {
+        lwshell_input(&data[idx], (len - idx) < chunk ? (len - idx) : chunk);
+    }
+#if LWSHELL_CFG_USE_ALLOC
+    lwshell_deinit();
+#endif /* LWSHELL_CFG_USE_ALLOC */
+}
+
+/**
+ * \brief           Reference tokenizer and dispatcher.
+ *
+ * Written for clarity, not speed. Any faster implementation in the library
+ * must produce identical transcript.
+ *
+ * \param[in]       tr: Transcript to fill
+ * \param[in,out]   line: Null-terminated line, modified in place
+ */
+static void
+prv_ref_parse_line(fuzz_transcript_t* tr, char* line) {
+    char* argv[LWSHELL_CFG_MAX_CMD_ARGS];
+    int32_t argc = 0;
+    size_t i = 0;
+
+    while (line[i] != '\0' && argc < LWSHELL_CFG_MAX_CMD_ARGS) {
+        if (line[i] == ' ') {
+            ++i;
+            continue;
+        }
+        if (line[i] == '"') {
+            /* Quoted token: backslash skips next character only if it is a quote */
+            argv[argc++] = &line[++i];
+            while (line[i] != '\0' && line[i] != '"') {
+                i += (line[i] == '\\' && line[i + 1] == '"') ? 2 : 1;
+            }
+            if (line[i] == '"') {
+                line[i++] = '\0';
+            }
+        } else {
+            /* Plain token: quote terminates argument, rest until space is ignored */
+            argv[argc++] = &line[i];
+            while (line[i] != '\0' && line[i] != ' ') {
+                if (line[i] == '"') {
+                    line[i] = '\0';
+                }
+                ++i;
+            }
+            if (line[i] == ' ') {
+                line[i++] = '\0';
+            }
+        }
+    }
+
+    if (argc == 0) {
+        return;
+    }
+    for (size_t idx = 0; idx < LWSHELL_ARRAYSIZE(cmd_names); ++idx) {
+        if (strcmp(cmd_names[idx], argv[0]) == 0) {
+            if (argc == 2 && strcmp(argv[1], "-h") == 0) {
+                if (cmd_descs[idx] != NULL) {
+                    prv_tr_append(tr, cmd_descs[idx], strlen(cmd_descs[idx]));
+                }
+                prv_tr_append(tr, LWSHELL_CFG_NEWLINE, strlen(LWSHELL_CFG_NEWLINE));
+            } else {
+                prv_tr_append_cmd(tr, argc, argv);
+            }
+            return;
+        }
+    }
+    prv_tr_append(tr, "Unknown command" LWSHELL_CFG_NEWLINE, strlen("Unknown command" LWSHELL_CFG_NEWLINE));
+}
+
+/**
+ * \brief           Reference input state machine
+ * \param[in]       tr: Transcript to fill
+ * \param[in]       data: Input data
+ * \param[in]       len: Input data length
+ */
+static void
+prv_run_ref(fuzz_transcript_t* tr, const uint8_t* data, size_t len) {
+    char line[LWSHELL_CFG_MAX_INPUT_LEN + 1];
+    size_t line_len = 0;
+    char line_end = 0;
+
+    tr->len = 0;
+    tr->overflow = 0;
+    for (size_t idx = 0; idx < len; ++idx) {
+        char ch = (char)data[idx], prev_end = line_end;
+
+        line_end = 0;
+        if (ch == '\r' || ch == '\n') {
+#if LWSHELL_CFG_USE_LINE_COALESCE
+            /* CRLF and LFCR pairs end the line only once */
+            if (prev_end != 0 && prev_end != ch) {
+                continue;
+            }
+            line_end = ch;
+            prv_tr_append(tr, LWSHELL_CFG_NEWLINE, strlen(LWSHELL_CFG_NEWLINE));
+#else
+            (void)prev_end;
+            prv_tr_append(tr, &ch, 1);
+#endif /* LWSHELL_CFG_USE_LINE_COALESCE */
+            line[line_len] = '\0';
+            prv_ref_parse_line(tr, line);
+            line_len = 0;
+        } else if (ch == '\b') {
+            if (line_len > 0) {
+                --line_len;
+                prv_tr_append(tr, "\b \b", 3);
+            }
+        } else {
+            /* Every other character is echoed, only printable ones are stored */
+            if (ch != '\0') {
+                prv_tr_append(tr, &ch, 1);
+            }
+            if (ch >= 0x20 && ch < 0x7F && line_len < LWSHELL_CFG_MAX_INPUT_LEN) {
+                line[line_len++] = ch;
+            }
+        }
+    }
+}
+
+/**
+ * \brief           Print data as escaped string to `stderr`
+ * \param[in]       name: Data name
+ * \param[in]       data: Data to print
+ * \param[in]       len: Data length
+ */
+static void
+prv_dump(const char* name, const void* data, size_t len) {
+    const uint8_t* d = data;
+
+    fprintf(stderr, "%s (%u bytes): \"", name, (unsigned)len);
+    for (size_t idx = 0; idx < len; ++idx) {
+        if (d[idx] >= 0x20 && d[idx] < 0x7F && d[idx] != '"' && d[idx] != '\\') {
+            fputc(d[idx], stderr);
+        } else {
+            fprintf(stderr, "\\x%02X", (unsigned)d[idx]);
+        }
+    }
+    fprintf(stderr, "\"\n");
+}
+
+/**
+ * \brief           Run single input through library and reference and compare results
+ * \param[in]       data: Input data
+ * \param[in]       len: Input data length
+ * \return          `0` when all transcripts match, `-1` otherwise
+ */
+static int
+prv_run_one(const uint8_t* data, size_t len) {
+    if (len > FUZZ_MAX_INPUT_LEN) {
+        len = FUZZ_MAX_INPUT_LEN;
+    }
+
+    prv_run_ref(&tr_ref, data, len);
+    prv_run_lib(&tr_lib, data, len, len > 0 ? len : 1);
+    prv_run_lib(&tr_lib_chunked, data, len, 1 + (len > 0 ? data[0] % 7 : 0));
+#if LWSHELL_FUZZ_ALLOC_FAIL
+    return 0;
+#endif /* LWSHELL_FUZZ_ALLOC_FAIL */
+
+    if (tr_lib.overflow || tr_lib_chunked.overflow || tr_ref.overflow || tr_lib.len != tr_ref.len
+        || memcmp(tr_lib.data, tr_ref.data, tr_ref.len) != 0 || tr_lib_chunked.len != tr_ref.len
+        || memcmp(tr_lib_chunked.data, tr_ref.data, tr_ref.len) != 0) {
+        fprintf(stderr, "Transcript mismatch\n");
+        prv_dump("input", data, len);
+        prv_dump("reference", tr_ref.data, tr_ref.len);
+        prv_dump("library", tr_lib.data, tr_lib.len);
+        prv_dump("library chunked", tr_lib_chunked.data, tr_lib_chunked.len);
+        return -1;
+    }
+    return 0;
+}
+
+#if defined(LWSHELL_FUZZ_LIBFUZZER)
+
+/* libFuzzer entry point */
+int
+LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (prv_run_one(data, size) != 0) {
+        abort();
+    }
+    return 0;
+}
+
+#else /* defined(LWSHELL_FUZZ_LIBFUZZER) */
+
+/* Random generator state */
+static uint32_t rnd_state;
+
+/**
+ * \brief           Get next pseudo-random number (xorshift32)
+ * \return          Random number
+ */
+static uint32_t
+prv_rand(void) {
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+/**
+ * \brief           Generate random input, biased towards characters with special meaning
+ * \param[out]      data: Buffer to fill
+ * \param[in]       max_len: Buffer length
+ * \return          Number of generated bytes
+ */
+static size_t
+prv_gen_input(uint8_t* data, size_t max_len) {
+    static const char alphabet[] = "aabbcmd   \"\"\\\\-h\b\r\n";
+    size_t len;
+
+    /* Mostly short inputs, sometimes long to exceed buffer and argument limits */
+    len = prv_rand() % ((prv_rand() % 8) == 0 ? max_len : (LWSHELL_CFG_MAX_INPUT_LEN / 2));
+    for (size_t idx = 0; idx < len; ++idx) {
+        uint32_t r = prv_rand();
+
+        if ((r % 16) == 0) {
+            data[idx] = (uint8_t)(r >> 8);
+        } else if ((r % 16) == 1 && idx + 2 < len) {
+            data[idx++] = 'a';
+            data[idx] = ' ';
+        } else {
+            data[idx] = (uint8_t)alphabet[(r >> 8) % (sizeof(alphabet) - 1)];
+        }
+    }
+    return len;
+}
+
+/**
+ * \brief           Run single input read from stream
+ * \param[in]       f: Stream to read from
+ * \return          `0` on success, `-1` otherwise
+ */
+static int
+prv_run_stream(FILE* f) {
+    static uint8_t data[FUZZ_MAX_INPUT_LEN];
+    size_t len;
+
+    len = fread(data, 1, sizeof(data), f);
+    return prv_run_one(data, len);
+}
+
+/* Program entry point */
+int
+main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "-r") == 0) {
+        static uint8_t data[4 * LWSHELL_CFG_MAX_INPUT_LEN];
+        unsigned long iterations = argc > 2 ? strtoul(argv[2], NULL, 0) : 100000UL;
+
+        rnd_state = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 0) : 0x12345678UL;
+        if (rnd_state == 0) {
+            rnd_state = 1;
+        }
+        for (unsigned long i = 0; i < iterations; ++i) {
+            if (prv_run_one(data, prv_gen_input(data, sizeof(data))) != 0) {
+                fprintf(stderr, "Failed at iteration %lu\n", i);
+                return 1;
+            }
+        }
+        printf("%lu random inputs OK\n", iterations);
+    } else if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            FILE* f = fopen(argv[i], "rb");
+            int res;
+
+            if (f == NULL) {
+                fprintf(stderr, "Cannot open %s\n", argv[i]);
+                return 1;
+            }
+            res = prv_run_stream(f);
+            fclose(f);
+            if (res != 0) {
+                return 1;
+            }
+        }
+    } else {
+        if (prv_run_stream(stdin) != 0) {
+            abort();
+        }
+    }
+    return 0;
+}
+
+#endif /* !defined(LWSHELL_FUZZ_LIBFUZZER) */
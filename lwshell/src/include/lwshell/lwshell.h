@@ -37,6 +37,9 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "lwshell/lwshell_opt.h"
+#if LWSHELL_CFG_USE_PRINTF
+#include <stdarg.h>
+#endif /* LWSHELL_CFG_USE_PRINTF */
 
 #ifdef __cplusplus
 extern "C" {
@@ -62,8 +65,88 @@ typedef enum {
     lwshellOK = 0x00, /*!< Everything OK */
     lwshellERRPAR,    /*!< Parameter error */
     lwshellERRMEM,    /*!< Memory error */
+    lwshellERR,       /*!< Operation not allowed in current state */
 } lwshellr_t;
 
+/**
+ * \brief           Structured output mode
+ */
+typedef enum {
+    LWSHELL_OUTPUT_MODE_HUMAN = 0x00, /*!< Human-readable `key: value` pairs, one record per line */
+    LWSHELL_OUTPUT_MODE_JSON,         /*!< Compact JSON object per line (JSON lines) */
+} lwshell_output_mode_t;
+
+/**
+ * \brief           Echo mode of received input
+ */
+typedef enum {
+    LWSHELL_ECHO_MODE_INTERACTIVE = 0x00, /*!< Every received character is echoed back, for terminals */
+    LWSHELL_ECHO_MODE_MASKED,             /*!< Printable characters are echoed as \ref LWSHELL_CFG_ECHO_MASK_CHAR */
+    LWSHELL_ECHO_MODE_NONE,               /*!< Nothing is echoed, line editing with backspace is still active */
+    LWSHELL_ECHO_MODE_RAW,                /*!< Nothing is echoed and backspace is ignored, for machine clients */
+} lwshell_echo_mode_t;
+
+/**
+ * \brief           Status of processed command line
+ */
+typedef enum {
+    lwshellSTATUS_OK = 0x00,   /*!< Command function has been called, its return value is available */
+    lwshellSTATUS_HELP,        /*!< Command help text has been printed */
+    lwshellSTATUS_BUILTIN,     /*!< Built-in command has been processed */
+    lwshellSTATUS_UNKNOWN_CMD, /*!< Command does not exist */
+} lwshell_status_t;
+
+#define LWSHELL_RESULT_FLAG_TRUNCATED          0x01 /*!< Line exceeded input buffer, extra characters were dropped */
+#define LWSHELL_RESULT_FLAG_TOO_MANY_ARGS      0x02 /*!< Line had more than \ref LWSHELL_CFG_MAX_CMD_ARGS arguments */
+#define LWSHELL_RESULT_FLAG_UNTERMINATED_QUOTE 0x04 /*!< Quoted argument was not closed */
+
+/**
+ * \brief           Transcript header, `LWSH` followed by format version.
+ *
+ * Header is followed by records, each consisting of:
+ *
+ *  - Record type, `LWSHELL_TRANSCRIPT_REC_*` value, `1` byte
+ *  - Time since previous record in milliseconds, variable length integer
+ *  - Data length in bytes, variable length integer
+ *  - Data
+ *
+ * Variable length integers use `7` bits per byte, least significant group first,
+ * with top bit set on all bytes except the last one.
+ * Readers shall skip records of unknown type.
+ */
+#define LWSHELL_TRANSCRIPT_MAGIC      {'L', 'W', 'S', 'H', 0x01}
+#define LWSHELL_TRANSCRIPT_REC_INPUT  0x01 /*!< Data passed to input function */
+#define LWSHELL_TRANSCRIPT_REC_OUTPUT 0x02 /*!< String passed to output function */
+#define LWSHELL_TRANSCRIPT_REC_CMD    0x03 /*!< Registered command, flags byte, null-terminated name and description */
+
+#define LWSHELL_TRANSCRIPT_CMD_FLAG_STATIC 0x01 /*!< Command record flag of static command */
+
+/**
+ * \brief           Result of processed command line
+ */
+typedef struct {
+    int32_t ret;    /*!< Return value of command function, valid for \ref lwshellSTATUS_OK status */
+    uint8_t status; /*!< Line status, member of \ref lwshell_status_t */
+    uint8_t flags;  /*!< Parse error flags, combination of `LWSHELL_RESULT_FLAG_*` values */
+} lwshell_result_t;
+
+#if LWSHELL_CFG_USE_COMPACT_LAYOUT || __DOXYGEN__
+#if LWSHELL_CFG_MAX_INPUT_LEN <= UINT8_MAX
+typedef uint8_t lwshell_idx_t; /*!< Index type for input buffer */
+#elif LWSHELL_CFG_MAX_INPUT_LEN <= UINT16_MAX
+typedef uint16_t lwshell_idx_t;
+#else
+typedef size_t lwshell_idx_t;
+#endif
+typedef uint8_t lwshell_argc_t; /*!< Type for number of arguments */
+typedef uint16_t lwshell_cnt_t; /*!< Type for number of commands */
+#else
+typedef size_t lwshell_idx_t;
+typedef int32_t lwshell_argc_t;
+typedef size_t lwshell_cnt_t;
+#endif /* LWSHELL_CFG_USE_COMPACT_LAYOUT || __DOXYGEN__ */
+typedef uint32_t lwshell_perm_t; /*!< Type for permission mask, same width in every layout */
+
 /* Forward declaration */
 struct lwshell;
 
@@ -82,6 +165,23 @@ typedef int32_t (*lwshell_cmd_fn)(int32_t argc, char** argv);
  */
 typedef void (*lwshell_output_fn)(const char* str, struct lwshell* lwobj);
 
+/**
+ * \brief           Callback function for streaming command payload
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       data: Payload data chunk, not null-terminated
+ * \param[in]       len: Length of payload data chunk in bytes
+ */
+typedef void (*lwshell_payload_fn)(struct lwshell* lwobj, const char* data, size_t len);
+
+/**
+ * \brief           Login function, called by built-in `login` command
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       argc: Number of arguments, including `login`
+ * \param[in]       argv: Pointer to arguments, eg. user name and password
+ * \return          New permission mask of the session, `0` to drop all privileges
+ */
+typedef lwshell_perm_t (*lwshell_login_fn)(struct lwshell* lwobj, int32_t argc, char** argv);
+
 /**
  * \brief           Shell command structure
  */
@@ -89,8 +189,38 @@ typedef struct {
     lwshell_cmd_fn fn; /*!< Command function to call on match */
     const char* name;  /*!< Command name to search for match */
     const char* desc;  /*!< Command description for help */
+#if LWSHELL_CFG_USE_PAYLOAD || __DOXYGEN__
+    lwshell_payload_fn payload_fn; /*!< Optional function to receive streaming payload.
+                                        Check \ref lwshell_register_payload_cmd_ex for details */
+#endif                             /* LWSHELL_CFG_USE_PAYLOAD || __DOXYGEN__ */
+#if LWSHELL_CFG_USE_PERMISSIONS || __DOXYGEN__
+    lwshell_perm_t perm; /*!< Permissions required to run the command, all must be granted to the session.
+                                Set to `0` to allow command to everyone */
+#endif                   /* LWSHELL_CFG_USE_PERMISSIONS || __DOXYGEN__ */
 } lwshell_cmd_t;
 
+/**
+ * \brief           Result callback function, called after every processed command line
+ * \param[in]       result: Result of processed line
+ * \param[in]       lwobj: LwSHELL instance
+ */
+typedef void (*lwshell_result_fn)(const lwshell_result_t* result, struct lwshell* lwobj);
+
+/**
+ * \brief           Time function, used for timestamps
+ * \param[in]       lwobj: LwSHELL instance
+ * \return          Current time in units of milliseconds
+ */
+typedef uint32_t (*lwshell_time_fn)(struct lwshell* lwobj);
+
+/**
+ * \brief           Transcript function, receiving recorded data to be stored by application
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       data: Transcript data, part of header or record
+ * \param[in]       len: Length of data in bytes
+ */
+typedef void (*lwshell_transcript_fn)(struct lwshell* lwobj, const void* data, size_t len);
+
 /**
  * \brief           LwSHELL main structure
  */
@@ -98,27 +228,142 @@ typedef struct lwshell {
 #if LWSHELL_CFG_USE_OUTPUT || __DOXYGEN__
     lwshell_output_fn out_fn;                 /*!< Optional output function */
 #endif                                        /* LWSHELL_CFG_USE_OUTPUT || __DOXYGEN__ */
+#if LWSHELL_CFG_USE_ALLOC || __DOXYGEN__
+    char* buff;       /*!< Shell command input buffer, allocated on demand */
+    size_t buff_size; /*!< Size of allocated input buffer in bytes */
+#else
     char buff[LWSHELL_CFG_MAX_INPUT_LEN + 1]; /*!< Shell command input buffer */
-    size_t buff_ptr;                          /*!< Buffer pointer for input */
-    int32_t argc;                             /*!< Number of arguments parsed in command */
-    char* argv[LWSHELL_CFG_MAX_CMD_ARGS];     /*!< Array of pointers to all arguments */
+#endif                                        /* LWSHELL_CFG_USE_ALLOC || __DOXYGEN__ */
+    lwshell_idx_t buff_ptr;                   /*!< Buffer pointer for input */
+    lwshell_argc_t argc;                      /*!< Number of arguments parsed in command */
+#if LWSHELL_CFG_USE_COMPACT_LAYOUT || __DOXYGEN__
+    lwshell_idx_t argv[LWSHELL_CFG_MAX_CMD_ARGS]; /*!< Array of argument offsets in input buffer */
+#else
+    char* argv[LWSHELL_CFG_MAX_CMD_ARGS]; /*!< Array of pointers to all arguments */
+#endif /* LWSHELL_CFG_USE_COMPACT_LAYOUT || __DOXYGEN__ */
 
 #if LWSHELL_CFG_USE_DYNAMIC_COMMANDS || __DOXYGEN__
+#if LWSHELL_CFG_USE_ALLOC || __DOXYGEN__
+    lwshell_cmd_t* dynamic_cmds;     /*!< Shell registered dynamic commands, allocated on demand */
+    lwshell_cnt_t dynamic_cmds_size; /*!< Number of allocated entries in dynamic commands table */
+#else
     lwshell_cmd_t dynamic_cmds[LWSHELL_CFG_MAX_DYNAMIC_CMDS]; /*!< Shell registered dynamic commands */
-    size_t dynamic_cmds_cnt;                                  /*!< Number of registered dynamic commands */
+#endif                              /* LWSHELL_CFG_USE_ALLOC || __DOXYGEN__ */
+    lwshell_cnt_t dynamic_cmds_cnt; /*!< Number of registered dynamic commands */
 #endif                                                        /* LWSHELL_CFG_USE_DYNAMIC_COMMANDS || __DOXYGEN__ */
 
+#if LWSHELL_CFG_USE_ECHO_MODE || __DOXYGEN__
+    uint8_t echo_mode; /*!< Echo mode, member of \ref lwshell_echo_mode_t */
+#endif                 /* LWSHELL_CFG_USE_ECHO_MODE || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_LINE_COALESCE || __DOXYGEN__
+    char line_end; /*!< Delimiter that ended previous line, when it was the last received character */
+#endif             /* LWSHELL_CFG_USE_LINE_COALESCE || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_PAYLOAD || __DOXYGEN__
+    lwshell_payload_fn payload_fn; /*!< Payload function of active streaming command, `NULL` when not active */
+    uint8_t payload_checked;       /*!< Set to `1` when current line has been checked for payload command */
+#endif                             /* LWSHELL_CFG_USE_PAYLOAD || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_VARS || __DOXYGEN__
+    char vars[LWSHELL_CFG_VARS_ARENA_SIZE];          /*!< Variables arena, entries stored as `name\0value\0` */
+    uint16_t vars_len;                               /*!< Number of used bytes in variables arena */
+    uint16_t vars_index[LWSHELL_CFG_VARS_HASH_SIZE]; /*!< Hash index, arena offset + 1 or `0` for empty slot */
+#endif                                               /* LWSHELL_CFG_USE_VARS || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_ALIAS || __DOXYGEN__
+    char aliases[LWSHELL_CFG_ALIAS_ARENA_SIZE]; /*!< Aliases arena with pre-tokenized commands */
+    uint16_t aliases_len;                       /*!< Number of used bytes in aliases arena */
+    uint8_t aliases_locked;                     /*!< Set to `1` while alias is executing, arena must not change */
+#endif                                          /* LWSHELL_CFG_USE_ALIAS || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_STRUCTURED_OUTPUT || __DOXYGEN__
+    uint8_t out_mode;    /*!< Structured output mode, member of \ref lwshell_output_mode_t */
+    uint8_t emit_fields; /*!< Set to `1` when current record has at least one field */
+#endif                   /* LWSHELL_CFG_USE_STRUCTURED_OUTPUT || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_RESULT || __DOXYGEN__
+    lwshell_result_t result;     /*!< Result of last processed command line */
+    lwshell_result_fn result_fn; /*!< Optional result callback function */
+    uint8_t line_flags;          /*!< Parse error flags of line currently being processed */
+#endif                           /* LWSHELL_CFG_USE_RESULT || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_PERMISSIONS || __DOXYGEN__
+    lwshell_perm_t perm;       /*!< Permissions granted to the session */
+    lwshell_login_fn login_fn; /*!< Optional login function for built-in `login` command */
+#endif                         /* LWSHELL_CFG_USE_PERMISSIONS || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_TRANSCRIPT || LWSHELL_CFG_USE_RATE_LIMIT || __DOXYGEN__
+    lwshell_time_fn time_fn; /*!< Optional time function for timestamps and rate limits */
+#endif                       /* LWSHELL_CFG_USE_TRANSCRIPT || LWSHELL_CFG_USE_RATE_LIMIT || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_TRANSCRIPT || __DOXYGEN__
+    lwshell_transcript_fn transcript_fn; /*!< Transcript function, `NULL` when not recording */
+    uint32_t transcript_time;            /*!< Time of the last transcript record */
+#endif                                   /* LWSHELL_CFG_USE_TRANSCRIPT || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_RATE_LIMIT || __DOXYGEN__
+    uint32_t rate[2];                             /*!< Limits of bytes and commands per second, `0` for none */
+    uint32_t rate_tokens[2];                      /*!< Bytes and commands buckets, in units of 1/1000 token */
+    uint32_t rate_time;                           /*!< Time of the last buckets refill */
+    char rate_queue[LWSHELL_CFG_RATE_QUEUE_SIZE]; /*!< Queue of input data waiting for processing */
+    uint16_t rate_queue_head;                     /*!< Position of the first queued byte */
+    uint16_t rate_queue_len;                      /*!< Number of queued bytes */
+    size_t rate_dropped;                          /*!< Number of input bytes dropped due to full queue */
+#endif                                            /* LWSHELL_CFG_USE_RATE_LIMIT || __DOXYGEN__ */
+
 #if LWSHELL_CFG_USE_STATIC_COMMANDS || __DOXYGEN__
     const lwshell_cmd_t* static_cmds; /*!< Pointer to an array of static commands */
-    size_t static_cmds_cnt;           /*!< Length of status commands array */
+    lwshell_cnt_t static_cmds_cnt;    /*!< Length of status commands array */
 #endif                                /* LWSHELL_CFG_USE_STATIC_COMMANDS || __DOXYGEN__ */
 } lwshell_t;
 
 lwshellr_t lwshell_init_ex(lwshell_t* lwobj);
+lwshellr_t lwshell_deinit_ex(lwshell_t* lwobj);
 lwshellr_t lwshell_set_output_fn_ex(lwshell_t* lwobj, lwshell_output_fn out_fn);
 lwshellr_t lwshell_register_cmd_ex(lwshell_t* lwobj, const char* cmd_name, lwshell_cmd_fn cmd_fn, const char* desc);
+lwshellr_t lwshell_register_payload_cmd_ex(lwshell_t* lwobj, const char* cmd_name, lwshell_cmd_fn cmd_fn,
+                                           lwshell_payload_fn payload_fn, const char* desc);
 lwshellr_t lwshell_input_ex(lwshell_t* lwobj, const void* in_data, size_t len);
 
+lwshellr_t lwshell_set_var_ex(lwshell_t* lwobj, const char* name, const char* value);
+const char* lwshell_get_var_ex(lwshell_t* lwobj, const char* name);
+
+lwshellr_t lwshell_set_alias_ex(lwshell_t* lwobj, const char* name, const char* def);
+
+lwshellr_t lwshell_set_echo_mode_ex(lwshell_t* lwobj, lwshell_echo_mode_t mode);
+
+#if LWSHELL_CFG_USE_PRINTF || LWSHELL_CFG_USE_STRUCTURED_OUTPUT || __DOXYGEN__
+lwshell_t* lwshell_get_current_ex(void);
+#endif /* LWSHELL_CFG_USE_PRINTF || LWSHELL_CFG_USE_STRUCTURED_OUTPUT || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_PRINTF || __DOXYGEN__
+size_t lwshell_printf_ex(lwshell_t* lwobj, const char* fmt, ...);
+size_t lwshell_vprintf_ex(lwshell_t* lwobj, const char* fmt, va_list args);
+#endif /* LWSHELL_CFG_USE_PRINTF || __DOXYGEN__ */
+
+lwshellr_t lwshell_set_output_mode_ex(lwshell_t* lwobj, lwshell_output_mode_t mode);
+lwshellr_t lwshell_emit_begin_ex(lwshell_t* lwobj);
+lwshellr_t lwshell_emit_str_ex(lwshell_t* lwobj, const char* key, const char* value);
+lwshellr_t lwshell_emit_int_ex(lwshell_t* lwobj, const char* key, long long value);
+lwshellr_t lwshell_emit_bool_ex(lwshell_t* lwobj, const char* key, uint8_t value);
+lwshellr_t lwshell_emit_end_ex(lwshell_t* lwobj);
+
+lwshellr_t lwshell_set_result_fn_ex(lwshell_t* lwobj, lwshell_result_fn result_fn);
+const lwshell_result_t* lwshell_get_result_ex(lwshell_t* lwobj);
+
+lwshellr_t lwshell_set_cmd_perm_ex(lwshell_t* lwobj, const char* cmd_name, lwshell_perm_t perm);
+lwshellr_t lwshell_set_perm_ex(lwshell_t* lwobj, lwshell_perm_t perm);
+lwshell_perm_t lwshell_get_perm_ex(lwshell_t* lwobj);
+lwshellr_t lwshell_set_login_fn_ex(lwshell_t* lwobj, lwshell_login_fn login_fn);
+
+lwshellr_t lwshell_set_time_fn_ex(lwshell_t* lwobj, lwshell_time_fn time_fn);
+lwshellr_t lwshell_set_transcript_fn_ex(lwshell_t* lwobj, lwshell_transcript_fn transcript_fn);
+
+lwshellr_t lwshell_set_rate_limit_ex(lwshell_t* lwobj, uint32_t bytes_per_s, uint32_t cmds_per_s);
+lwshellr_t lwshell_process_ex(lwshell_t* lwobj);
+size_t lwshell_get_dropped_ex(lwshell_t* lwobj);
+
 lwshellr_t lwshell_register_static_cmds_ex(lwshell_t* lwobj, const lwshell_cmd_t* cmds, size_t cmds_len);
 
 /**
@@ -128,6 +373,14 @@ lwshellr_t lwshell_register_static_cmds_ex(lwshell_t* lwobj, const lwshell_cmd_t
  */
 #define lwshell_init()                               lwshell_init_ex(NULL)
 
+/**
+ * \brief           Release memory allocated by shell interface
+ * \note            It applies to default shell instance
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_ALLOC is enabled
+ */
+#define lwshell_deinit()                             lwshell_deinit_ex(NULL)
+
 /**
  * \brief           Set output function to use to print data from library to user
  * \note            It applies to default shell instance
@@ -148,6 +401,20 @@ lwshellr_t lwshell_register_static_cmds_ex(lwshell_t* lwobj, const lwshell_cmd_t
  */
 #define lwshell_register_cmd(cmd_name, cmd_fn, desc) lwshell_register_cmd_ex(NULL, (cmd_name), (cmd_fn), (desc))
 
+/**
+ * \brief           Register new command with streaming payload to shell
+ * \note            It applies to default shell instance
+ * \param[in]       cmd_name: Command name. This one is used when entering shell command
+ * \param[in]       cmd_fn: Function to call at the end of line
+ * \param[in]       payload_fn: Function to call for every received payload chunk
+ * \param[in]       desc: Custom command description
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_DYNAMIC_COMMANDS
+ *                  and \ref LWSHELL_CFG_USE_PAYLOAD are enabled
+ */
+#define lwshell_register_payload_cmd(cmd_name, cmd_fn, payload_fn, desc)                                              \
+    lwshell_register_payload_cmd_ex(NULL, (cmd_name), (cmd_fn), (payload_fn), (desc))
+
 /**
  * \brief           Input data to shell processing
  * \note            It applies to default shell instance
@@ -167,6 +434,216 @@ lwshellr_t lwshell_register_static_cmds_ex(lwshell_t* lwobj, const lwshell_cmd_t
  */
 #define lwshell_register_static_cmds(cmds, cmds_len) lwshell_register_static_cmds_ex(NULL, (cmds), (cmds_len))
 
+/**
+ * \brief           Set, overwrite or delete shell variable
+ * \note            It applies to default shell instance
+ * \param[in]       name: Variable name. It must not include space, `"` or `$` characters
+ * \param[in]       value: Variable value. Set to `NULL` to delete variable
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_VARS is enabled
+ */
+#define lwshell_set_var(name, value)                 lwshell_set_var_ex(NULL, (name), (value))
+
+/**
+ * \brief           Get shell variable value
+ * \note            It applies to default shell instance
+ * \param[in]       name: Variable name
+ * \return          Pointer to null-terminated value on success, `NULL` if variable does not exist
+ * \note            Available only when \ref LWSHELL_CFG_USE_VARS is enabled
+ */
+#define lwshell_get_var(name)                        lwshell_get_var_ex(NULL, (name))
+
+/**
+ * \brief           Define, overwrite or delete command alias
+ * \note            It applies to default shell instance
+ * \param[in]       name: Alias name. It must not include space, `"`, `;` or `$` characters
+ *                      and must not be name of built-in or registered command
+ * \param[in]       def: Alias definition, eg. `"status -v all"` or `"reset; status"`.
+ *                      Set to `NULL` to delete alias
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise.
+ *                  \ref lwshellERR when called from command executed by an alias
+ * \note            Aliases cannot be changed while an alias is executing
+ * \note            Available only when \ref LWSHELL_CFG_USE_ALIAS is enabled
+ */
+#define lwshell_set_alias(name, def)                 lwshell_set_alias_ex(NULL, (name), (def))
+
+/**
+ * \brief           Set echo mode
+ * \note            It applies to default shell instance
+ * \param[in]       mode: Echo mode, member of \ref lwshell_echo_mode_t
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_ECHO_MODE is enabled
+ */
+#define lwshell_set_echo_mode(mode)                  lwshell_set_echo_mode_ex(NULL, (mode))
+
+/**
+ * \brief           Print formatted string through output function
+ * \note            It applies to the instance currently executing command function,
+ *                  or default shell instance when called outside of command function
+ * \param[in]       ...: Format string and its arguments
+ * \return          Number of formatted characters
+ * \note            Available only when \ref LWSHELL_CFG_USE_PRINTF is enabled
+ */
+#define lwshell_printf(...)                          lwshell_printf_ex(NULL, __VA_ARGS__)
+
+/**
+ * \brief           Set output mode for structured output functions
+ * \note            It applies to default shell instance
+ * \param[in]       mode: Output mode, member of \ref lwshell_output_mode_t
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+#define lwshell_set_output_mode(mode)                lwshell_set_output_mode_ex(NULL, (mode))
+
+/**
+ * \brief           Begin new structured output record
+ * \note            It applies to the instance currently executing command function,
+ *                  or default shell instance when called outside of command function
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+#define lwshell_emit_begin()                         lwshell_emit_begin_ex(NULL)
+
+/**
+ * \brief           Emit string field to current record
+ * \note            It applies to the instance currently executing command function,
+ *                  or default shell instance when called outside of command function
+ * \param[in]       key: Field key
+ * \param[in]       value: Null-terminated string value
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+#define lwshell_emit_str(key, value)                 lwshell_emit_str_ex(NULL, (key), (value))
+
+/**
+ * \brief           Emit integer field to current record
+ * \note            It applies to the instance currently executing command function,
+ *                  or default shell instance when called outside of command function
+ * \param[in]       key: Field key
+ * \param[in]       value: Integer value
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+#define lwshell_emit_int(key, value)                 lwshell_emit_int_ex(NULL, (key), (value))
+
+/**
+ * \brief           Emit boolean field to current record
+ * \note            It applies to the instance currently executing command function,
+ *                  or default shell instance when called outside of command function
+ * \param[in]       key: Field key
+ * \param[in]       value: Boolean value
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+#define lwshell_emit_bool(key, value)                lwshell_emit_bool_ex(NULL, (key), (value))
+
+/**
+ * \brief           End current structured output record
+ * \note            It applies to the instance currently executing command function,
+ *                  or default shell instance when called outside of command function
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+#define lwshell_emit_end()                           lwshell_emit_end_ex(NULL)
+
+/**
+ * \brief           Set function called with result of every processed command line
+ * \note            It applies to default shell instance
+ * \param[in]       result_fn: Result function. Set to `NULL` to disable the notification
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_RESULT is enabled
+ */
+#define lwshell_set_result_fn(result_fn)             lwshell_set_result_fn_ex(NULL, (result_fn))
+
+/**
+ * \brief           Get result of last processed command line
+ * \note            It applies to default shell instance
+ * \return          Pointer to result, valid until next line is processed
+ * \note            Available only when \ref LWSHELL_CFG_USE_RESULT is enabled
+ */
+#define lwshell_get_result()                         lwshell_get_result_ex(NULL)
+
+/**
+ * \brief           Set permissions required to run dynamic command
+ * \note            It applies to default shell instance
+ * \param[in]       cmd_name: Name of registered dynamic command
+ * \param[in]       perm: Required permission mask, `0` to allow command to everyone
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_PERMISSIONS
+ *                  and \ref LWSHELL_CFG_USE_DYNAMIC_COMMANDS are enabled
+ */
+#define lwshell_set_cmd_perm(cmd_name, perm)         lwshell_set_cmd_perm_ex(NULL, (cmd_name), (perm))
+
+/**
+ * \brief           Set permissions granted to the session
+ * \note            It applies to default shell instance
+ * \param[in]       perm: Granted permission mask
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_PERMISSIONS is enabled
+ */
+#define lwshell_set_perm(perm)                       lwshell_set_perm_ex(NULL, (perm))
+
+/**
+ * \brief           Get permissions granted to the session
+ * \note            It applies to default shell instance
+ * \return          Granted permission mask
+ * \note            Available only when \ref LWSHELL_CFG_USE_PERMISSIONS is enabled
+ */
+#define lwshell_get_perm()                           lwshell_get_perm_ex(NULL)
+
+/**
+ * \brief           Set login function for built-in `login` command
+ * \note            It applies to default shell instance
+ * \param[in]       login_fn: Login function. Set to `NULL` to disable `login` command
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_PERMISSIONS is enabled
+ */
+#define lwshell_set_login_fn(login_fn)               lwshell_set_login_fn_ex(NULL, (login_fn))
+
+/**
+ * \brief           Set time function, used for timestamps
+ * \note            It applies to default shell instance
+ * \param[in]       time_fn: Time function
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_TRANSCRIPT or \ref LWSHELL_CFG_USE_RATE_LIMIT is enabled
+ */
+#define lwshell_set_time_fn(time_fn)                 lwshell_set_time_fn_ex(NULL, (time_fn))
+
+/**
+ * \brief           Start or stop transcript recording
+ * \note            It applies to default shell instance
+ * \param[in]       transcript_fn: Function receiving transcript data. Set to `NULL` to stop recording
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_TRANSCRIPT is enabled
+ */
+#define lwshell_set_transcript_fn(transcript_fn)     lwshell_set_transcript_fn_ex(NULL, (transcript_fn))
+
+/**
+ * \brief           Set input rate limits
+ * \note            It applies to default shell instance
+ * \param[in]       bytes_per_s: Maximum number of processed input bytes per second. `0` for no limit
+ * \param[in]       cmds_per_s: Maximum number of executed commands per second. `0` for no limit
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_RATE_LIMIT is enabled
+ */
+#define lwshell_set_rate_limit(bytes_per_s, cmds_per_s) lwshell_set_rate_limit_ex(NULL, (bytes_per_s), (cmds_per_s))
+
+/**
+ * \brief           Process input data queued due to rate limits
+ * \note            It applies to default shell instance
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_RATE_LIMIT is enabled
+ */
+#define lwshell_process()                            lwshell_process_ex(NULL)
+
+/**
+ * \brief           Get number of input bytes dropped due to full rate limiting queue
+ * \note            It applies to default shell instance
+ * \return          Number of dropped bytes
+ * \note            Available only when \ref LWSHELL_CFG_USE_RATE_LIMIT is enabled
+ */
+#define lwshell_get_dropped()                        lwshell_get_dropped_ex(NULL)
+
 /**
  * \brief           Parse input string as `integer`
  * \param[in]       str: String to parse
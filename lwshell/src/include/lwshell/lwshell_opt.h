@@ -70,6 +70,29 @@ extern "C" {
 #define LWSHELL_MEMCPY(dst, src, len) memcpy((dst), (src), (len))
 #endif
 
+/**
+ * \brief           Memory reallocation function
+ *
+ * Used only when \ref LWSHELL_CFG_USE_ALLOC is enabled.
+ * Application may redirect it to its own arena or pool allocator.
+ *
+ * \note            Function footprint is the same as \ref realloc
+ */
+#ifndef LWSHELL_REALLOC
+#define LWSHELL_REALLOC(ptr, size) realloc((ptr), (size))
+#endif
+
+/**
+ * \brief           Memory free function
+ *
+ * Used only when \ref LWSHELL_CFG_USE_ALLOC is enabled.
+ *
+ * \note            Function footprint is the same as \ref free
+ */
+#ifndef LWSHELL_FREE
+#define LWSHELL_FREE(ptr) free((ptr))
+#endif
+
 /**
  * \brief           Enables `1` or disables `0` dynamic command register with \ref lwshell_register_cmd or \ref lwshell_register_cmd_ex functions
  * 
@@ -142,6 +165,134 @@ extern "C" {
 #define LWSHELL_CFG_MAX_CMD_ARGS 8
 #endif
 
+/**
+ * \brief           Enables `1` or disables `0` compact instance layout.
+ *
+ * When enabled, \ref lwshell_t uses smallest integer types for indexes and counters,
+ * selected according to \ref LWSHELL_CFG_MAX_INPUT_LEN value,
+ * and stores arguments as offsets in the input buffer instead of full pointers.
+ * Pointers are materialized on the stack only when command is dispatched.
+ *
+ * This reduces RAM usage when many shell instances are used in the application.
+ */
+#ifndef LWSHELL_CFG_USE_COMPACT_LAYOUT
+#define LWSHELL_CFG_USE_COMPACT_LAYOUT 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` growable input buffer and dynamic commands table.
+ *
+ * When enabled, input buffer and dynamic commands table are allocated
+ * with \ref LWSHELL_REALLOC when needed and grow geometrically.
+ * \ref LWSHELL_CFG_MAX_INPUT_LEN and \ref LWSHELL_CFG_MAX_DYNAMIC_CMDS become upper limits
+ * instead of statically allocated sizes.
+ *
+ * Memory is only allocated when line or command table exceeds its largest size so far,
+ * never on regular line processing. Use \ref lwshell_deinit_ex to release memory.
+ *
+ * \note            Intended for hosted builds
+ */
+#ifndef LWSHELL_CFG_USE_ALLOC
+#define LWSHELL_CFG_USE_ALLOC 0
+#endif
+
+/**
+ * \brief           Initial input buffer length in units of characters
+ *
+ * \note            Used only when \ref LWSHELL_CFG_USE_ALLOC is enabled
+ */
+#ifndef LWSHELL_CFG_ALLOC_INPUT_LEN_INIT
+#define LWSHELL_CFG_ALLOC_INPUT_LEN_INIT 32
+#endif
+
+/**
+ * \brief           Initial number of entries in dynamic commands table
+ *
+ * \note            Used only when \ref LWSHELL_CFG_USE_ALLOC is enabled
+ */
+#ifndef LWSHELL_CFG_ALLOC_DYNAMIC_CMDS_INIT
+#define LWSHELL_CFG_ALLOC_DYNAMIC_CMDS_INIT 4
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` streaming payload commands.
+ *
+ * Payload command receives everything after its name until the end of line
+ * in chunks, as data arrive, instead of buffering the whole line.
+ * This allows large data (firmware chunks, configuration blobs)
+ * to pass through the shell without large \ref LWSHELL_CFG_MAX_INPUT_LEN.
+ *
+ * \sa              lwshell_register_payload_cmd_ex
+ */
+#ifndef LWSHELL_CFG_USE_PAYLOAD
+#define LWSHELL_CFG_USE_PAYLOAD 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` shell variables.
+ *
+ * Variables are set with built-in `set name value` command (or \ref lwshell_set_var_ex function),
+ * deleted with `set name` and listed with `set`.
+ * Unquoted `$name` argument is replaced with variable value before command is called.
+ * Only whole arguments are expanded, `$name` inside of longer argument, such as `x$name`, is passed unmodified.
+ *
+ * Variables are stored in fixed-size per-instance arena, with small hash index for lookup.
+ * Expansion does not copy or allocate memory, argument points directly to the value in the arena,
+ * hence command functions must not modify expanded arguments.
+ */
+#ifndef LWSHELL_CFG_USE_VARS
+#define LWSHELL_CFG_USE_VARS 0
+#endif
+
+/**
+ * \brief           Size of variables arena in bytes, per instance
+ *
+ * Every variable uses length of name and value, plus `2` bytes
+ *
+ * \note            Used only when \ref LWSHELL_CFG_USE_VARS is enabled
+ */
+#ifndef LWSHELL_CFG_VARS_ARENA_SIZE
+#define LWSHELL_CFG_VARS_ARENA_SIZE 128
+#endif
+
+/**
+ * \brief           Number of slots in variables hash index.
+ *
+ * It is also maximum number of variables per instance
+ *
+ * \note            Used only when \ref LWSHELL_CFG_USE_VARS is enabled
+ */
+#ifndef LWSHELL_CFG_VARS_HASH_SIZE
+#define LWSHELL_CFG_VARS_HASH_SIZE 8
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` command aliases and macros.
+ *
+ * Aliases are defined with built-in `alias name command args...` command
+ * (or \ref lwshell_set_alias_ex function), deleted with `alias name` and listed with `alias`.
+ * Multiple commands, separated with `;`, form a macro, eg. `alias boot "reset; status -v"`.
+ *
+ * Aliases are stored pre-tokenized, with commands looked-up by name at invocation time.
+ * Invoking alias dispatches stored commands directly, without tokenizer.
+ * Alias cannot shadow built-in or registered command, commands always take precedence.
+ *
+ * \note            Arguments of stored commands point to the aliases arena
+ *                  and must not be modified by command functions
+ */
+#ifndef LWSHELL_CFG_USE_ALIAS
+#define LWSHELL_CFG_USE_ALIAS 0
+#endif
+
+/**
+ * \brief           Size of aliases arena in bytes, per instance
+ *
+ * \note            Used only when \ref LWSHELL_CFG_USE_ALIAS is enabled
+ */
+#ifndef LWSHELL_CFG_ALIAS_ARENA_SIZE
+#define LWSHELL_CFG_ALIAS_ARENA_SIZE 128
+#endif
+
 /**
  * \brief           Enables `1` or disables `0` output function to
  *                  print data from library to application.
@@ -152,6 +303,182 @@ extern "C" {
 #define LWSHELL_CFG_USE_OUTPUT 1
 #endif
 
+/**
+ * \brief           Newline sequence, printed at the end of every library output line
+ *
+ * When \ref LWSHELL_CFG_USE_LINE_COALESCE is enabled, it is also echoed once per received line
+ */
+#ifndef LWSHELL_CFG_NEWLINE
+#define LWSHELL_CFG_NEWLINE "\r\n"
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` coalescing of line delimiters.
+ *
+ * When enabled, `CR`, `LF`, `CRLF` and `LFCR` sequences all end the line exactly once,
+ * and \ref LWSHELL_CFG_NEWLINE is echoed instead of received delimiter characters.
+ * Terminal clients sending `CRLF` this way produce single line event and single echo per line.
+ *
+ * When disabled, `CR` and `LF` are processed as independent line delimiters and echoed as received
+ *
+ * \note            Delimiters handling and \ref LWSHELL_CFG_NEWLINE are selected at compile time,
+ *                  equally for all instances. There is no per-instance setting
+ */
+#ifndef LWSHELL_CFG_USE_LINE_COALESCE
+#define LWSHELL_CFG_USE_LINE_COALESCE 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` per-instance echo modes.
+ *
+ * Echo mode is set at runtime with \ref lwshell_set_echo_mode_ex function,
+ * to interactive, masked (password), no-echo or raw mode.
+ * Modes without echo do not call output function for received characters.
+ *
+ * When disabled, every received character is always echoed back
+ */
+#ifndef LWSHELL_CFG_USE_ECHO_MODE
+#define LWSHELL_CFG_USE_ECHO_MODE 0
+#endif
+
+/**
+ * \brief           Character echoed instead of printable characters in masked echo mode
+ *
+ * \note            Used only when \ref LWSHELL_CFG_USE_ECHO_MODE is enabled
+ */
+#ifndef LWSHELL_CFG_ECHO_MASK_CHAR
+#define LWSHELL_CFG_ECHO_MASK_CHAR '*'
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` command permissions.
+ *
+ * Every command has mask of required permissions and every session (shell instance)
+ * has mask of granted permissions. Command runs only if session has all of its permissions,
+ * otherwise it is treated as unknown command and is not listed by `listcmd`.
+ *
+ * Session permissions are set by application or by built-in `login` command,
+ * when login function is set with \ref lwshell_set_login_fn_ex.
+ *
+ * Built-in `listcmd`, `set`, `alias` and `login` commands are available to every session.
+ * Aliases can only be defined with commands the session may run,
+ * and are not listed when session may not run any of their commands.
+ */
+#ifndef LWSHELL_CFG_USE_PERMISSIONS
+#define LWSHELL_CFG_USE_PERMISSIONS 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` session transcript recording.
+ *
+ * Raw input data and produced output are recorded with timestamps in compact binary format,
+ * passed to application function set with \ref lwshell_set_transcript_fn_ex.
+ * Recording can be replayed on host with `lwshell_replay` tool.
+ */
+#ifndef LWSHELL_CFG_USE_TRANSCRIPT
+#define LWSHELL_CFG_USE_TRANSCRIPT 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` input rate limiting.
+ *
+ * Input bytes per second and executed commands per second are limited with token buckets,
+ * set with \ref lwshell_set_rate_limit_ex function. Input over the limits is queued
+ * and processed later, when queue is full, input data is dropped.
+ *
+ * \note            Time function must be set with \ref lwshell_set_time_fn_ex
+ */
+#ifndef LWSHELL_CFG_USE_RATE_LIMIT
+#define LWSHELL_CFG_USE_RATE_LIMIT 0
+#endif
+
+/**
+ * \brief           Size of input queue in units of bytes, used by rate limiting
+ *
+ * \note            Used only when \ref LWSHELL_CFG_USE_RATE_LIMIT is enabled
+ */
+#ifndef LWSHELL_CFG_RATE_QUEUE_SIZE
+#define LWSHELL_CFG_RATE_QUEUE_SIZE 64
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` result reporting of processed command lines.
+ *
+ * Return value of command function, line status and parse errors
+ * are available with \ref lwshell_get_result_ex function and optional callback,
+ * set with \ref lwshell_set_result_fn_ex function.
+ */
+#ifndef LWSHELL_CFG_USE_RESULT
+#define LWSHELL_CFG_USE_RESULT 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` formatted output with \ref lwshell_printf_ex function
+ *
+ * Lightweight formatter writes output in chunks through instance output function,
+ * without large stack buffer or heap allocation.
+ *
+ * \ref LWSHELL_CFG_USE_OUTPUT must be enabled to use this feature
+ */
+#ifndef LWSHELL_CFG_USE_PRINTF
+#define LWSHELL_CFG_USE_PRINTF 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` `%f` floating point specifier in \ref lwshell_printf_ex
+ *
+ * Value is rounded to nearest digit with ties to even, same as libc `printf`,
+ * for all finite values and precision up to `15` digits.
+ * `?` is printed in place of value with larger precision, as its digits cannot be exact with double arithmetic.
+ * When disabled, floating point argument is consumed and `?` is printed in its place
+ *
+ * \note            Used only when \ref LWSHELL_CFG_USE_PRINTF is enabled
+ */
+#ifndef LWSHELL_CFG_PRINTF_FLOAT
+#define LWSHELL_CFG_PRINTF_FLOAT 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` structured output with `lwshell_emit_*` functions.
+ *
+ * Command functions emit records of fields, rendered by the shell either human-readable
+ * or as compact JSON lines, depending on \ref lwshell_set_output_mode_ex setting.
+ *
+ * \ref LWSHELL_CFG_USE_OUTPUT must be enabled to use this feature
+ */
+#ifndef LWSHELL_CFG_USE_STRUCTURED_OUTPUT
+#define LWSHELL_CFG_USE_STRUCTURED_OUTPUT 0
+#endif
+
+/**
+ * \brief           Size of formatter chunk buffer on stack, in characters.
+ *
+ * Output function is called every time chunk buffer is full
+ *
+ * \note            Used only when \ref LWSHELL_CFG_USE_PRINTF
+ *                  or \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+#ifndef LWSHELL_CFG_PRINTF_CHUNK_SIZE
+#define LWSHELL_CFG_PRINTF_CHUNK_SIZE 16
+#endif
+
+/**
+ * \brief           Storage class specifier of pointer to instance currently executing command function.
+ *
+ * Functions called with `NULL` instance from command function, such as \ref lwshell_printf,
+ * apply to the instance executing the command. By default this is single process-wide pointer,
+ * hence commands of different instances must not be processed concurrently from different threads.
+ *
+ * Set to `_Thread_local` (C11) or compiler specific equivalent, such as `__thread`,
+ * to keep separate pointer per thread and process every instance from its own thread
+ *
+ * \note            Used only when \ref LWSHELL_CFG_USE_PRINTF
+ *                  or \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+#ifndef LWSHELL_CFG_THREAD_LOCAL
+#define LWSHELL_CFG_THREAD_LOCAL
+#endif
+
 /**
  * \brief           Enables `1` or disables `0` generic ˙listcmd` command to list of registered commands
  *
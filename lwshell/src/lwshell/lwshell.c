@@ -33,6 +33,13 @@
  */
 #include <string.h>
 #include "lwshell/lwshell.h"
+#if LWSHELL_CFG_USE_PRINTF
+#include <limits.h>
+#include <stdarg.h>
+#if LWSHELL_CFG_PRINTF_FLOAT
+#include <float.h>
+#endif /* LWSHELL_CFG_PRINTF_FLOAT */
+#endif /* LWSHELL_CFG_USE_PRINTF */
 
 /* Check enabled features */
 #if LWSHELL_CFG_USE_LIST_CMD && !LWSHELL_CFG_USE_OUTPUT
@@ -41,6 +48,25 @@
 #if !LWSHELL_CFG_USE_DYNAMIC_COMMANDS && !LWSHELL_CFG_USE_STATIC_COMMANDS
 #error "At least one of LWSHELL_CFG_USE_DYNAMIC_COMMANDS or !LWSHELL_CFG_USE_STATIC_COMMANDS must be enabled"
 #endif /* !LWSHELL_CFG_USE_DYNAMIC_COMMANDS && !LWSHELL_CFG_USE_STATIC_COMMANDS */
+#if LWSHELL_CFG_USE_COMPACT_LAYOUT                                                                                     \
+    && (LWSHELL_CFG_MAX_CMD_ARGS > UINT8_MAX || LWSHELL_CFG_MAX_DYNAMIC_CMDS > UINT16_MAX)
+#error "LWSHELL_CFG_MAX_CMD_ARGS or LWSHELL_CFG_MAX_DYNAMIC_CMDS too large for LWSHELL_CFG_USE_COMPACT_LAYOUT"
+#endif /* LWSHELL_CFG_USE_COMPACT_LAYOUT && ... */
+#if LWSHELL_CFG_USE_PRINTF && !LWSHELL_CFG_USE_OUTPUT
+#error "To use printf feature, LWSHELL_CFG_USE_OUTPUT must be enabled"
+#endif /* LWSHELL_CFG_USE_PRINTF && !LWSHELL_CFG_USE_OUTPUT */
+#if LWSHELL_CFG_USE_STRUCTURED_OUTPUT && !LWSHELL_CFG_USE_OUTPUT
+#error "To use structured output feature, LWSHELL_CFG_USE_OUTPUT must be enabled"
+#endif /* LWSHELL_CFG_USE_STRUCTURED_OUTPUT && !LWSHELL_CFG_USE_OUTPUT */
+#if LWSHELL_CFG_USE_ALIAS && LWSHELL_CFG_ALIAS_ARENA_SIZE > UINT16_MAX
+#error "LWSHELL_CFG_ALIAS_ARENA_SIZE must not exceed 65535 bytes"
+#endif /* LWSHELL_CFG_USE_ALIAS && LWSHELL_CFG_ALIAS_ARENA_SIZE > UINT16_MAX */
+#if LWSHELL_CFG_USE_VARS && LWSHELL_CFG_VARS_ARENA_SIZE > UINT16_MAX
+#error "LWSHELL_CFG_VARS_ARENA_SIZE must not exceed 65535 bytes"
+#endif /* LWSHELL_CFG_USE_VARS && LWSHELL_CFG_VARS_ARENA_SIZE > UINT16_MAX */
+#if LWSHELL_CFG_USE_RATE_LIMIT && (LWSHELL_CFG_RATE_QUEUE_SIZE > UINT16_MAX || LWSHELL_CFG_RATE_QUEUE_SIZE < 1)
+#error "LWSHELL_CFG_RATE_QUEUE_SIZE must be between 1 and 65535 bytes"
+#endif /* LWSHELL_CFG_USE_RATE_LIMIT && (LWSHELL_CFG_RATE_QUEUE_SIZE > UINT16_MAX || ...) */
 
 /* Default characters */
 #define LWSHELL_ASCII_NULL      0x00 /*!< Null character */
@@ -50,10 +76,22 @@
 #define LWSHELL_ASCII_DEL       0x7F /*!< Delete character */
 #define LWSHELL_ASCII_SPACE     0x20 /*!< Space character */
 
+#if LWSHELL_CFG_USE_TRANSCRIPT
+#define LWSHELL_TRANSCRIPT(lwobj, type, data, len)                                                                     \
+    do {                                                                                                               \
+        if ((lwobj)->transcript_fn != NULL) {                                                                          \
+            prv_transcript_rec((lwobj), (type), (data), (len));                                                        \
+        }                                                                                                              \
+    } while (0)
+#else
+#define LWSHELL_TRANSCRIPT(lwobj, type, data, len)
+#endif /* LWSHELL_CFG_USE_TRANSCRIPT */
+
 #if LWSHELL_CFG_USE_OUTPUT
 #define LWSHELL_OUTPUT(lwobj, str)                                                                                     \
     do {                                                                                                               \
         if ((lwobj)->out_fn != NULL && (str) != NULL) {                                                                \
+            LWSHELL_TRANSCRIPT((lwobj), LWSHELL_TRANSCRIPT_REC_OUTPUT, (str), strlen(str));                            \
             (lwobj)->out_fn((str), (lwobj));                                                                           \
         }                                                                                                              \
     } while (0)
@@ -61,198 +99,1944 @@
 #define LWSHELL_OUTPUT(lwobj, str)
 #endif
 
+/* Check if received characters are echoed back and if line editing with backspace is enabled */
+#if LWSHELL_CFG_USE_ECHO_MODE
+#define LWSHELL_ECHO_ON(lwobj)   ((lwobj)->echo_mode <= LWSHELL_ECHO_MODE_MASKED)
+#define LWSHELL_LINE_EDIT(lwobj) ((lwobj)->echo_mode != LWSHELL_ECHO_MODE_RAW)
+#else
+#define LWSHELL_ECHO_ON(lwobj)   1
+#define LWSHELL_LINE_EDIT(lwobj) 1
+#endif /* LWSHELL_CFG_USE_ECHO_MODE */
+
 /* Array of all commands */
 static lwshell_t shell;
 
+#if LWSHELL_CFG_USE_TRANSCRIPT
+
+/**
+ * \brief           Encode unsigned number as variable length integer, `7` bits per byte, LSB first
+ * \param[out]      out: Output buffer, at least `10` bytes long
+ * \param[in]       val: Value to encode
+ * \return          Number of bytes written
+ */
+static size_t
+prv_transcript_varint(uint8_t* out, unsigned long long val) {
+    size_t len = 0;
+
+    for (; val >= 0x80U; val >>= 7) {
+        out[len++] = (uint8_t)(val | 0x80U);
+    }
+    out[len++] = (uint8_t)val;
+    return len;
+}
+
+/**
+ * \brief           Write transcript record header to transcript function
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       type: Record type, `LWSHELL_TRANSCRIPT_REC_*` value
+ * \param[in]       len: Length of record data in bytes, written next
+ */
+static void
+prv_transcript_hdr(lwshell_t* lwobj, uint8_t type, size_t len) {
+    uint8_t hdr[1 + 10 + 10];
+    size_t hdr_len = 0;
+    uint32_t now = lwobj->time_fn != NULL ? lwobj->time_fn(lwobj) : 0;
+
+    hdr[hdr_len++] = type;
+    hdr_len += prv_transcript_varint(&hdr[hdr_len], (uint32_t)(now - lwobj->transcript_time));
+    hdr_len += prv_transcript_varint(&hdr[hdr_len], len);
+    lwobj->transcript_time = now;
+    lwobj->transcript_fn(lwobj, hdr, hdr_len);
+}
+
+/**
+ * \brief           Write transcript record to transcript function
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       type: Record type, `LWSHELL_TRANSCRIPT_REC_*` value
+ * \param[in]       data: Record data
+ * \param[in]       len: Length of record data in bytes
+ */
+static void
+prv_transcript_rec(lwshell_t* lwobj, uint8_t type, const void* data, size_t len) {
+    prv_transcript_hdr(lwobj, type, len);
+    lwobj->transcript_fn(lwobj, data, len);
+}
+
+/**
+ * \brief           Write registered command record, name and description, to transcript function
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       ccmd: Registered command
+ * \param[in]       flags: Record flags, `LWSHELL_TRANSCRIPT_CMD_FLAG_*` values
+ */
+static void
+prv_transcript_cmd(lwshell_t* lwobj, const lwshell_cmd_t* ccmd, uint8_t flags) {
+    const char* desc = ccmd->desc != NULL ? ccmd->desc : "";
+    size_t name_len = strlen(ccmd->name) + 1, desc_len = strlen(desc) + 1;
+
+    prv_transcript_hdr(lwobj, LWSHELL_TRANSCRIPT_REC_CMD, 1 + name_len + desc_len);
+    lwobj->transcript_fn(lwobj, &flags, 1);
+    lwobj->transcript_fn(lwobj, ccmd->name, name_len);
+    lwobj->transcript_fn(lwobj, desc, desc_len);
+}
+
+#endif /* LWSHELL_CFG_USE_TRANSCRIPT */
+
 /* Get shell instance from input */
 #define LWSHELL_GET_LWOBJ(lwobj) ((lwobj) != NULL ? (lwobj) : (&shell))
 
+/* Track instance executing command, for output functions called without instance */
+#define LWSHELL_USE_CURRENT (LWSHELL_CFG_USE_PRINTF || LWSHELL_CFG_USE_STRUCTURED_OUTPUT)
+
+#if LWSHELL_USE_CURRENT
+/* Instance currently executing command function, shared by all instances unless thread-local */
+static LWSHELL_CFG_THREAD_LOCAL lwshell_t* shell_current;
+
+/* Get shell instance from input, preferring the one currently executing command */
+#define LWSHELL_GET_LWOBJ_CUR(lwobj)                                                                                   \
+    ((lwobj) != NULL ? (lwobj) : (shell_current != NULL ? shell_current : (&shell)))
+#endif /* LWSHELL_USE_CURRENT */
+
+#if LWSHELL_CFG_USE_ALLOC
+#define LWSHELL_BUFF_SIZE(lwobj)      ((lwobj)->buff_size)
+#define LWSHELL_BUFF_GROW(lwobj)      prv_buff_grow(lwobj)
+#define LWSHELL_DYN_CMDS_SIZE(lwobj)  ((lwobj)->dynamic_cmds_size)
+#define LWSHELL_DYN_CMDS_GROW(lwobj)  prv_dyn_cmds_grow(lwobj)
+#else
+#define LWSHELL_BUFF_SIZE(lwobj)      LWSHELL_ARRAYSIZE((lwobj)->buff)
+#define LWSHELL_BUFF_GROW(lwobj)      0
+#define LWSHELL_DYN_CMDS_SIZE(lwobj)  LWSHELL_ARRAYSIZE((lwobj)->dynamic_cmds)
+#define LWSHELL_DYN_CMDS_GROW(lwobj)  0
+#endif /* LWSHELL_CFG_USE_ALLOC */
+
+#if LWSHELL_CFG_USE_RESULT
+#define LWSHELL_SET_LINE_FLAG(lwobj, flag) ((lwobj)->line_flags |= (uint8_t)(flag))
+#define LWSHELL_SET_RESULT(lwobj, st, rv)                                                                              \
+    do {                                                                                                               \
+        (lwobj)->result.status = (uint8_t)(st);                                                                        \
+        (lwobj)->result.ret = (rv);                                                                                    \
+    } while (0)
+#define LWSHELL_RESET_RESULT(lwobj) ((lwobj)->line_flags = 0)
+#else
+#define LWSHELL_SET_LINE_FLAG(lwobj, flag)
+#define LWSHELL_SET_RESULT(lwobj, st, rv) (void)(rv)
+#define LWSHELL_RESET_RESULT(lwobj)
+#endif /* LWSHELL_CFG_USE_RESULT */
+
 /* Add character to instance */
 #define LWSHELL_ADD_CH(lwobj, ch)                                                                                      \
     do {                                                                                                               \
-        if ((lwobj)->buff_ptr < (LWSHELL_ARRAYSIZE((lwobj)->buff) - 1)) {                                              \
+        if (((lwobj)->buff_ptr + 1U) < LWSHELL_BUFF_SIZE(lwobj) || LWSHELL_BUFF_GROW(lwobj)) {                         \
             (lwobj)->buff[(lwobj)->buff_ptr] = ch;                                                                     \
             (lwobj)->buff[++(lwobj)->buff_ptr] = '\0';                                                                 \
+        } else {                                                                                                       \
+            LWSHELL_SET_LINE_FLAG(lwobj, LWSHELL_RESULT_FLAG_TRUNCATED);                                               \
         }                                                                                                              \
     } while (0)
 
+/* Set next argument, either as pointer or offset in the buffer */
+#if LWSHELL_CFG_USE_COMPACT_LAYOUT
+#define LWSHELL_SET_ARG(lwobj, str) ((lwobj)->argv[(lwobj)->argc++] = (lwshell_idx_t)((str) - (lwobj)->buff))
+#else
+#define LWSHELL_SET_ARG(lwobj, str) ((lwobj)->argv[(lwobj)->argc++] = (str))
+#endif /* LWSHELL_CFG_USE_COMPACT_LAYOUT */
+
 /* Reset buffers */
 #define LWSHELL_RESET_BUFF(lwobj)                                                                                      \
     do {                                                                                                               \
-        LWSHELL_MEMSET((lwobj)->buff, 0x00, sizeof((lwobj)->buff));                                                    \
+        if ((lwobj)->buff_ptr > 0) {                                                                                   \
+            /* Buffer after write pointer is always cleared */                                                         \
+            LWSHELL_MEMSET((lwobj)->buff, 0x00, (lwobj)->buff_ptr);                                                    \
+        }                                                                                                              \
         LWSHELL_MEMSET((lwobj)->argv, 0x00, sizeof((lwobj)->argv));                                                    \
         (lwobj)->buff_ptr = 0;                                                                                         \
     } while (0)
 
+#if LWSHELL_CFG_USE_ALLOC
+
 /**
- * \brief           Parse input string
+ * \brief           Grow memory block geometrically, up to maximum number of elements
+ * \param[in,out]   ptr: Pointer to memory block, updated on success
+ * \param[in]       cnt: Current number of elements
+ * \param[in]       cnt_init: Number of elements for the first allocation
+ * \param[in]       cnt_max: Maximum number of elements
+ * \param[in]       el_size: Size of single element in bytes
+ * \return          New number of elements on success, `0` otherwise
+ */
+static size_t
+prv_grow(void** ptr, size_t cnt, size_t cnt_init, size_t cnt_max, size_t el_size) {
+    size_t new_cnt = cnt > 0 ? (cnt * 2U) : cnt_init;
+    void* new_ptr;
+
+    if (new_cnt > cnt_max) {
+        new_cnt = cnt_max;
+    }
+    if (new_cnt <= cnt || (new_ptr = LWSHELL_REALLOC(*ptr, new_cnt * el_size)) == NULL) {
+        return 0;
+    }
+    LWSHELL_MEMSET((char*)new_ptr + cnt * el_size, 0x00, (new_cnt - cnt) * el_size);
+    *ptr = new_ptr;
+    return new_cnt;
+}
+
+/**
+ * \brief           Grow input buffer to accept at least one more character
+ * \param[in]       lwobj: LwSHELL instance
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+prv_buff_grow(lwshell_t* lwobj) {
+    void* ptr = lwobj->buff;
+    size_t size;
+
+    size = prv_grow(&ptr, lwobj->buff_size, LWSHELL_CFG_ALLOC_INPUT_LEN_INIT + 1, LWSHELL_CFG_MAX_INPUT_LEN + 1, 1);
+    if (size == 0) {
+        return 0;
+    }
+    lwobj->buff = ptr;
+    lwobj->buff_size = size;
+    return 1;
+}
+
+#if LWSHELL_CFG_USE_DYNAMIC_COMMANDS
+
+/**
+ * \brief           Grow dynamic commands table to accept at least one more command
+ * \param[in]       lwobj: LwSHELL instance
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+prv_dyn_cmds_grow(lwshell_t* lwobj) {
+    void* ptr = lwobj->dynamic_cmds;
+    size_t size;
+
+    size = prv_grow(&ptr, lwobj->dynamic_cmds_size, LWSHELL_CFG_ALLOC_DYNAMIC_CMDS_INIT, LWSHELL_CFG_MAX_DYNAMIC_CMDS,
+                    sizeof(*lwobj->dynamic_cmds));
+    if (size == 0) {
+        return 0;
+    }
+    lwobj->dynamic_cmds = ptr;
+    lwobj->dynamic_cmds_size = (lwshell_cnt_t)size;
+    return 1;
+}
+
+#endif /* LWSHELL_CFG_USE_DYNAMIC_COMMANDS */
+
+#endif /* LWSHELL_CFG_USE_ALLOC */
+
+/* Reset payload streaming state */
+#if LWSHELL_CFG_USE_PAYLOAD
+#define LWSHELL_RESET_PAYLOAD(lwobj)                                                                                   \
+    do {                                                                                                               \
+        (lwobj)->payload_fn = NULL;                                                                                    \
+        (lwobj)->payload_checked = 0;                                                                                  \
+    } while (0)
+#else
+#define LWSHELL_RESET_PAYLOAD(lwobj)
+#endif /* LWSHELL_CFG_USE_PAYLOAD */
+
+/* Check if session has all permissions required by the command */
+#if LWSHELL_CFG_USE_PERMISSIONS
+#define LWSHELL_CMD_ALLOWED(lwobj, ccmd) (((ccmd)->perm & ~(lwobj)->perm) == 0)
+#else
+#define LWSHELL_CMD_ALLOWED(lwobj, ccmd) 1
+#endif /* LWSHELL_CFG_USE_PERMISSIONS */
+
+/**
+ * \brief           Find registered command by its name.
+ *
+ * Commands not allowed to the session are treated as non-existing, unless `check_perm` is `0`
+ *
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       name: Command name, does not need to be null-terminated
+ * \param[in]       name_len: Length of command name
+ * \param[in]       check_perm: Set to `1` to skip commands not allowed to the session
+ * \return          Pointer to command on success, `NULL` otherwise
+ */
+static const lwshell_cmd_t*
+prv_find_cmd(lwshell_t* lwobj, const char* name, size_t name_len, uint8_t check_perm) {
+#if LWSHELL_CFG_USE_DYNAMIC_COMMANDS
+    /* Process all dynamic commands */
+    for (size_t idx = 0; idx < lwobj->dynamic_cmds_cnt; ++idx) {
+        if ((!check_perm || LWSHELL_CMD_ALLOWED(lwobj, &lwobj->dynamic_cmds[idx]))
+            && name_len == strlen(lwobj->dynamic_cmds[idx].name)
+            && strncmp(lwobj->dynamic_cmds[idx].name, name, name_len) == 0) {
+            return &lwobj->dynamic_cmds[idx];
+        }
+    }
+#endif /* LWSHELL_CFG_USE_DYNAMIC_COMMANDS */
+
+#if LWSHELL_CFG_USE_STATIC_COMMANDS
+    /* Process all static commands */
+    if (lwobj->static_cmds != NULL) {
+        for (size_t idx = 0; idx < lwobj->static_cmds_cnt; ++idx) {
+            if ((!check_perm || LWSHELL_CMD_ALLOWED(lwobj, &lwobj->static_cmds[idx]))
+                && name_len == strlen(lwobj->static_cmds[idx].name)
+                && strncmp(lwobj->static_cmds[idx].name, name, name_len) == 0) {
+                return &lwobj->static_cmds[idx];
+            }
+        }
+    }
+#endif /* LWSHELL_CFG_USE_STATIC_COMMANDS */
+    return NULL;
+}
+
+#if LWSHELL_CFG_USE_PAYLOAD
+
+/**
+ * \brief           Check if command name in the buffer belongs to payload command
+ *                  and start payload streaming if it does.
+ *
+ * Called when first space character after command name is received
+ *
  * \param[in]       lwobj: LwSHELL instance
  */
 static void
-prv_parse_input(lwshell_t* lwobj) {
-    size_t s_len;
-    char* str;
+prv_payload_check(lwshell_t* lwobj) {
+    const lwshell_cmd_t* ccmd;
+    const char* name = lwobj->buff;
+    size_t name_len;
 
-    /* Check string length and compare with buffer pointer */
-    s_len = strlen(lwobj->buff);
-    if (s_len != lwobj->buff_ptr) {
+    while (*name == ' ') {
+        ++name;
+    }
+    if (*name == '\0') {
+        return; /* Only leading spaces so far */
+    }
+    lwobj->payload_checked = 1;
+
+    /* Name ends with space, unless buffer is already full */
+    name_len = strlen(name);
+    if (name[name_len - 1] != ' ') {
         return;
     }
+    ccmd = prv_find_cmd(lwobj, name, name_len - 1, 1);
+    if (ccmd != NULL && ccmd->payload_fn != NULL) {
+        lwobj->payload_fn = ccmd->payload_fn;
+    }
+}
 
-    /* Must be more than `1` character since we have to include end of line */
-    if (lwobj->buff_ptr > 0) {
-        /* Set default values */
-        lwobj->argc = 0;
-        lwobj->argv[0] = lwobj->buff;
+#endif /* LWSHELL_CFG_USE_PAYLOAD */
 
-        /* Process complete input */
-        str = lwobj->buff;
+#if LWSHELL_CFG_USE_VARS
 
-        /* Process complete string */
-        while (*str != '\0') {
-            while (*str == ' ' && ++str) {} /* Remove leading spaces */
-            if (*str == '\0') {
-                break;
+/**
+ * \brief           Calculate variable name hash (FNV-1a)
+ * \param[in]       name: Null-terminated variable name
+ * \return          Name hash
+ */
+static uint32_t
+prv_var_hash(const char* name) {
+    uint32_t hash = 2166136261UL;
+
+    for (; *name != '\0'; ++name) {
+        hash = (hash ^ (uint8_t)*name) * 16777619UL;
+    }
+    return hash;
+}
+
+/**
+ * \brief           Find hash index slot of the variable
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       name: Null-terminated variable name
+ * \param[out]      empty_slot: Output for first empty slot in the probe sequence.
+ *                      Set to \ref LWSHELL_CFG_VARS_HASH_SIZE if index is full. Can be set to `NULL`
+ * \return          Slot index on success, \ref LWSHELL_CFG_VARS_HASH_SIZE if variable does not exist
+ */
+static size_t
+prv_var_find(lwshell_t* lwobj, const char* name, size_t* empty_slot) {
+    size_t slot = prv_var_hash(name) % LWSHELL_CFG_VARS_HASH_SIZE;
+
+    if (empty_slot != NULL) {
+        *empty_slot = LWSHELL_CFG_VARS_HASH_SIZE;
+    }
+    for (size_t i = 0; i < LWSHELL_CFG_VARS_HASH_SIZE; ++i, slot = (slot + 1) % LWSHELL_CFG_VARS_HASH_SIZE) {
+        if (lwobj->vars_index[slot] == 0) {
+            if (empty_slot != NULL) {
+                *empty_slot = slot;
             }
+            break;
+        }
+        if (strcmp(&lwobj->vars[lwobj->vars_index[slot] - 1], name) == 0) {
+            return slot;
+        }
+    }
+    return LWSHELL_CFG_VARS_HASH_SIZE;
+}
 
-            /* Check if it starts with quote to handle escapes */
-            if (*str == '"') {
-                ++str;
-                lwobj->argv[lwobj->argc++] = str; /* Set start of argument after quotes */
+/**
+ * \brief           Get length of variable entry in the arena
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       off: Offset of variable entry in the arena
+ * \return          Entry length in bytes
+ */
+static size_t
+prv_var_entry_len(lwshell_t* lwobj, size_t off) {
+    size_t len;
 
-                /* Process until end of quote */
-                while (*str != '\0') {
-                    if (*str == '\\') {
-                        ++str;
-                        if (*str == '"') {
-                            ++str;
-                        }
-                    } else if (*str == '"') {
-                        *str = '\0';
-                        ++str;
-                        break;
-                    } else {
+    /* Entry is stored as "name\0value\0" */
+    len = strlen(&lwobj->vars[off]) + 1;
+    len += strlen(&lwobj->vars[off + len]) + 1;
+    return len;
+}
+
+/**
+ * \brief           Remove variable from the arena and rebuild hash index
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       off: Offset of variable entry in the arena
+ */
+static void
+prv_var_remove(lwshell_t* lwobj, size_t off) {
+    size_t len = prv_var_entry_len(lwobj, off), empty_slot;
+
+    memmove(&lwobj->vars[off], &lwobj->vars[off + len], lwobj->vars_len - off - len);
+    lwobj->vars_len -= (uint16_t)len;
+
+    /* Arena offsets changed, rebuild complete index */
+    LWSHELL_MEMSET(lwobj->vars_index, 0x00, sizeof(lwobj->vars_index));
+    for (off = 0; off < lwobj->vars_len;) {
+        prv_var_find(lwobj, &lwobj->vars[off], &empty_slot);
+        lwobj->vars_index[empty_slot] = (uint16_t)(off + 1U);
+        off += strlen(&lwobj->vars[off]) + 1;
+        off += strlen(&lwobj->vars[off]) + 1;
+    }
+}
+
+/**
+ * \brief           Expand variable, when argument has `$name` form
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       arg: Argument to expand
+ * \return          Variable value if variable exists, `arg` otherwise
+ */
+static char*
+prv_var_expand(lwshell_t* lwobj, char* arg) {
+    if (arg[0] == '$') {
+        const char* value = lwshell_get_var_ex(lwobj, &arg[1]);
+        if (value != NULL) {
+            return (char*)value;
+        }
+    }
+    return arg;
+}
+
+/**
+ * \brief           Built-in `set` command to set, delete or list variables
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ */
+static void
+prv_set_cmd(lwshell_t* lwobj, size_t argc, char** argv) {
+    if (argc == 1U) {
+        for (size_t off = 0; off < lwobj->vars_len;) {
+            LWSHELL_OUTPUT(lwobj, &lwobj->vars[off]);
+            off += strlen(&lwobj->vars[off]) + 1;
+            LWSHELL_OUTPUT(lwobj, "=");
+            LWSHELL_OUTPUT(lwobj, &lwobj->vars[off]);
+            off += strlen(&lwobj->vars[off]) + 1;
+            LWSHELL_OUTPUT(lwobj, LWSHELL_CFG_NEWLINE);
+        }
+    } else if (lwshell_set_var_ex(lwobj, argv[1], argc > 2U ? argv[2] : NULL) != lwshellOK) {
+        LWSHELL_OUTPUT(lwobj, "Cannot set variable" LWSHELL_CFG_NEWLINE);
+    }
+}
+
+#endif /* LWSHELL_CFG_USE_VARS */
+
+/**
+ * \brief           Split input string to arguments
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in,out]   str: Null-terminated string to process, modified in place
+ */
+static void
+prv_tokenize(lwshell_t* lwobj, char* str) {
+    lwobj->argc = 0;
+
+    /* Process complete string */
+    while (*str != '\0') {
+        while (*str == ' ' && ++str) {} /* Remove leading spaces */
+        if (*str == '\0') {
+            break;
+        }
+
+        /* Check if it starts with quote to handle escapes */
+        if (*str == '"') {
+            ++str;
+            LWSHELL_SET_ARG(lwobj, str); /* Set start of argument after quotes */
+
+            /* Process until end of quote */
+            while (*str != '\0') {
+                if (*str == '\\') {
+                    ++str;
+                    if (*str == '"') {
                         ++str;
                     }
-                }
-            } else {
-                lwobj->argv[lwobj->argc++] = str; /* Set start of argument directly on character */
-                while (*str != ' ' && *str != '\0') {
-                    if (*str == '"') { /* Quote should not be here... */
-                        *str = '\0';   /* ...add NULL termination to end token */
-                    }
+                } else if (*str == '"') {
+                    *str = '\0';
                     ++str;
-                }
-                if (*str == '\0') {
                     break;
+                } else {
+                    ++str;
                 }
-                *str = '\0';
-                ++str;
             }
 
-            /* Check for number of arguments */
-            if (lwobj->argc == LWSHELL_ARRAYSIZE(lwobj->argv)) {
+            /* Closing quote has been replaced with null-termination */
+            if (str[-1] != '\0') {
+                LWSHELL_SET_LINE_FLAG(lwobj, LWSHELL_RESULT_FLAG_UNTERMINATED_QUOTE);
+            }
+        } else {
+            LWSHELL_SET_ARG(lwobj, str); /* Set start of argument directly on character */
+            while (*str != ' ' && *str != '\0') {
+                if (*str == '"') { /* Quote should not be here... */
+                    *str = '\0';   /* ...add NULL termination to end token */
+                }
+                ++str;
+            }
+            if (*str == '\0') {
                 break;
             }
+            *str = '\0';
+            ++str;
         }
 
-        /* Check for command */
-        if (lwobj->argc > 0) {
-            const lwshell_cmd_t* ccmd = NULL;
-            size_t arg_len = strlen(lwobj->argv[0]);
-
-#if LWSHELL_CFG_USE_DYNAMIC_COMMANDS
-            /* Process all dynamic commands */
-            if (ccmd == NULL && lwobj->dynamic_cmds_cnt > 0) {
-                for (size_t idx = 0; idx < lwobj->dynamic_cmds_cnt; ++idx) {
-                    if (arg_len == strlen(lwobj->dynamic_cmds[idx].name)
-                        && strncmp(lwobj->dynamic_cmds[idx].name, lwobj->argv[0], arg_len) == 0) {
-                        ccmd = &lwobj->dynamic_cmds[idx];
-                        break;
-                    }
-                }
+        /* Check for number of arguments */
+        if (lwobj->argc == LWSHELL_ARRAYSIZE(lwobj->argv)) {
+#if LWSHELL_CFG_USE_RESULT
+            while (*str == ' ') {
+                ++str;
             }
-#endif /* LWSHELL_CFG_USE_DYNAMIC_COMMANDS */
-
-#if LWSHELL_CFG_USE_STATIC_COMMANDS
-            /* Process all static commands */
-            if (ccmd == NULL && lwobj->static_cmds != NULL && lwobj->static_cmds_cnt > 0) {
-                for (size_t idx = 0; idx < lwobj->static_cmds_cnt; ++idx) {
-                    if (arg_len == strlen(lwobj->static_cmds[idx].name)
-                        && strncmp(lwobj->static_cmds[idx].name, lwobj->argv[0], arg_len) == 0) {
-                        ccmd = &lwobj->static_cmds[idx];
-                        break;
-                    }
-                }
+            if (*str != '\0') {
+                LWSHELL_SET_LINE_FLAG(lwobj, LWSHELL_RESULT_FLAG_TOO_MANY_ARGS);
             }
-#endif /* LWSHELL_CFG_USE_STATIC_COMMANDS */
+#endif /* LWSHELL_CFG_USE_RESULT */
+            break;
+        }
+    }
+}
 
-            /* Valid command ready? */
-            if (ccmd != NULL) {
-                if (lwobj->argc == 2U && lwobj->argv[1][0] == '-' && lwobj->argv[1][1] == 'h'
-                    && lwobj->argv[1][2] == '\0') {
-                    /* Here we can print version */
-                    LWSHELL_OUTPUT(lwobj, ccmd->desc);
-                    LWSHELL_OUTPUT(lwobj, "\r\n");
-                } else {
-                    ccmd->fn(lwobj->argc, lwobj->argv);
-                }
-#if LWSHELL_CFG_USE_LIST_CMD
-            } else if (strncmp(lwobj->argv[0], "listcmd", 7U) == 0) {
-                LWSHELL_OUTPUT(lwobj, "List of registered commands\r\n");
-#if LWSHELL_CFG_USE_DYNAMIC_COMMANDS
-                for (size_t idx = 0; idx < lwobj->dynamic_cmds_cnt; ++idx) {
-                    LWSHELL_OUTPUT(lwobj, lwobj->dynamic_cmds[idx].name);
-                    LWSHELL_OUTPUT(lwobj, "\t\t\t");
-                    LWSHELL_OUTPUT(lwobj, lwobj->dynamic_cmds[idx].desc);
-                    LWSHELL_OUTPUT(lwobj, "\r\n");
-                }
-#endif /* LWSHELL_CFG_USE_DYNAMIC_COMMANDS */
-#if LWSHELL_CFG_USE_STATIC_COMMANDS
-                for (size_t idx = 0; idx < lwobj->static_cmds_cnt; ++idx) {
-                    LWSHELL_OUTPUT(lwobj, lwobj->static_cmds[idx].name);
-                    LWSHELL_OUTPUT(lwobj, "\t\t\t");
-                    LWSHELL_OUTPUT(lwobj, lwobj->static_cmds[idx].desc);
-                    LWSHELL_OUTPUT(lwobj, "\r\n");
-                }
-#endif /* LWSHELL_CFG_USE_STATIC_COMMANDS */
-#endif /* LWSHELL_CFG_USE_LIST_CMD */
-            } else {
-                LWSHELL_OUTPUT(lwobj, "Unknown command\r\n");
-            }
+/**
+ * \brief           Get pointers to parsed arguments, with variables expanded
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[out]      argv: Array of at least \ref LWSHELL_CFG_MAX_CMD_ARGS elements to fill
+ */
+static void
+prv_get_args(lwshell_t* lwobj, char** argv) {
+    for (size_t idx = 0; idx < (size_t)lwobj->argc; ++idx) {
+#if LWSHELL_CFG_USE_COMPACT_LAYOUT
+        /* Materialize argument pointers from buffer offsets */
+        argv[idx] = &lwobj->buff[lwobj->argv[idx]];
+#else
+        argv[idx] = lwobj->argv[idx];
+#endif /* LWSHELL_CFG_USE_COMPACT_LAYOUT */
+#if LWSHELL_CFG_USE_VARS
+        /* Quoted arguments are kept as they are */
+        if (argv[idx] == lwobj->buff || argv[idx][-1] != '"') {
+            argv[idx] = prv_var_expand(lwobj, argv[idx]);
+        }
+#endif /* LWSHELL_CFG_USE_VARS */
+    }
+}
+
+/**
+ * \brief           Execute command or print its help text
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       ccmd: Command to execute
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ */
+static void
+prv_exec_cmd(lwshell_t* lwobj, const lwshell_cmd_t* ccmd, size_t argc, char** argv) {
+    if (argc == 2U && argv[1][0] == '-' && argv[1][1] == 'h' && argv[1][2] == '\0') {
+        /* Here we can print version */
+        LWSHELL_OUTPUT(lwobj, ccmd->desc);
+        LWSHELL_OUTPUT(lwobj, LWSHELL_CFG_NEWLINE);
+        LWSHELL_SET_RESULT(lwobj, lwshellSTATUS_HELP, 0);
+    } else {
+        int32_t ret;
+#if LWSHELL_USE_CURRENT
+        lwshell_t* prev = shell_current;
+
+        shell_current = lwobj; /* Command function may print to its instance */
+        ret = ccmd->fn((int32_t)argc, argv);
+        shell_current = prev;
+#else
+        ret = ccmd->fn((int32_t)argc, argv);
+#endif /* LWSHELL_USE_CURRENT */
+        LWSHELL_SET_RESULT(lwobj, lwshellSTATUS_OK, ret);
+    }
+#if !LWSHELL_CFG_USE_OUTPUT && !LWSHELL_USE_CURRENT && !LWSHELL_CFG_USE_RESULT
+    (void)lwobj;
+#endif /* !LWSHELL_CFG_USE_OUTPUT && !LWSHELL_USE_CURRENT && !LWSHELL_CFG_USE_RESULT */
+}
+
+#if LWSHELL_CFG_USE_ALIAS
+
+/**
+ * \brief           Get length of alias entry in the arena.
+ *
+ * Entry starts with null-terminated name and number of commands.
+ * Every command follows with number of arguments and null-terminated arguments,
+ * starting with command name. Command is looked-up by its name on every invocation,
+ * hence alias never runs a different command after command tables change.
+ *
+ * \param[in]       entry: Pointer to alias entry
+ * \return          Entry length in bytes
+ */
+static size_t
+prv_alias_entry_len(const char* entry) {
+    const char* ptr = entry + strlen(entry) + 1;
+    uint8_t steps = (uint8_t)*ptr++;
+
+    for (; steps > 0; --steps) {
+        uint8_t argc = (uint8_t)*ptr++;
+
+        for (; argc > 0; --argc) {
+            ptr += strlen(ptr) + 1;
+        }
+    }
+    return (size_t)(ptr - entry);
+}
+
+/**
+ * \brief           Find alias by its name
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       name: Alias name, does not need to be null-terminated
+ * \param[in]       name_len: Length of alias name
+ * \return          Offset of alias entry in the arena, `aliases_len` if alias does not exist
+ */
+static size_t
+prv_alias_find(lwshell_t* lwobj, const char* name, size_t name_len) {
+    size_t off;
+
+    for (off = 0; off < lwobj->aliases_len; off += prv_alias_entry_len(&lwobj->aliases[off])) {
+        if (name_len == strlen(&lwobj->aliases[off]) && strncmp(&lwobj->aliases[off], name, name_len) == 0) {
+            break;
+        }
+    }
+    return off;
+}
+
+/**
+ * \brief           Check if alias name is taken by built-in or registered command.
+ *
+ * Commands take precedence over aliases, also commands the session is not allowed to run
+ *
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       name: Alias name, does not need to be null-terminated
+ * \param[in]       name_len: Length of alias name
+ * \return          `1` if name is reserved, `0` otherwise
+ */
+static uint8_t
+prv_alias_reserved(lwshell_t* lwobj, const char* name, size_t name_len) {
+    static const char* const builtins[] = {"listcmd", "set", "login", "alias"};
+
+    for (size_t idx = 0; idx < LWSHELL_ARRAYSIZE(builtins); ++idx) {
+        if (name_len == strlen(builtins[idx]) && strncmp(builtins[idx], name, name_len) == 0) {
+            return 1;
+        }
+    }
+    return prv_find_cmd(lwobj, name, name_len, 0) != NULL;
+}
+
+/**
+ * \brief           Remove alias entry from the arena
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       off: Offset of alias entry in the arena
+ */
+static void
+prv_alias_remove(lwshell_t* lwobj, size_t off) {
+    size_t len = prv_alias_entry_len(&lwobj->aliases[off]);
+
+    memmove(&lwobj->aliases[off], &lwobj->aliases[off + len], lwobj->aliases_len - off - len);
+    lwobj->aliases_len -= (uint16_t)len;
+}
+
+/**
+ * \brief           Define new alias, replacing existing one with the same name.
+ *
+ * Definition is split to words on space and `;` characters, where `;` separates commands.
+ * First word of every command must be a registered command, checked immediately.
+ *
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       name: Alias name
+ * \param[in]       def_cnt: Number of definition strings. Set to `0` to delete alias
+ * \param[in]       def: Array of definition strings
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ */
+static lwshellr_t
+prv_alias_define(lwshell_t* lwobj, const char* name, size_t def_cnt, const char* const* def) {
+    size_t old_off, start, off, steps_off, argc_off = 0, len;
+    uint8_t steps = 0, new_step = 1;
+    char* arena = lwobj->aliases;
+
+    /* Executing alias reads its arguments from the arena */
+    if (lwobj->aliases_locked) {
+        return lwshellERR;
+    }
+
+    if (name == NULL || *name == '\0' || strpbrk(name, " \";$") != NULL) {
+        return lwshellERRPAR;
+    }
+    old_off = prv_alias_find(lwobj, name, strlen(name));
+    if (def_cnt == 0) {
+        if (old_off < lwobj->aliases_len) {
+            prv_alias_remove(lwobj, old_off);
+        }
+        return lwshellOK;
+    }
+    if (prv_alias_reserved(lwobj, name, strlen(name))) {
+        return lwshellERRPAR; /* Alias must not shadow a command */
+    }
+
+    /* Build new entry after existing ones, commit only when complete */
+    start = off = lwobj->aliases_len;
+    len = strlen(name) + 1;
+    if (off + len + 1 > sizeof(lwobj->aliases)) {
+        return lwshellERRMEM;
+    }
+    LWSHELL_MEMCPY(&arena[off], name, len);
+    off += len;
+    steps_off = off++;
+    for (size_t idx = 0; idx < def_cnt; ++idx) {
+        for (const char* word = def[idx]; *word != '\0'; word += len) {
+            len = 1;
+            if (*word == ';') {
+                new_step = 1;
+                continue;
+            } else if (*word == ' ') {
+                continue;
+            }
+            len = strcspn(word, " ;");
+
+            /* First word is command, it must exist at definition time */
+            if (new_step) {
+                if (prv_find_cmd(lwobj, word, len, 1) == NULL || steps == UINT8_MAX) {
+                    return lwshellERRPAR;
+                }
+                if (off + 1 > sizeof(lwobj->aliases)) {
+                    return lwshellERRMEM;
+                }
+                argc_off = off;
+                arena[off++] = 0;
+                ++steps;
+                new_step = 0;
+            }
+            if ((uint8_t)arena[argc_off] >= LWSHELL_CFG_MAX_CMD_ARGS) {
+                return lwshellERRPAR;
+            }
+            if (off + len + 1 > sizeof(lwobj->aliases)) {
+                return lwshellERRMEM;
+            }
+            LWSHELL_MEMCPY(&arena[off], word, len);
+            off += len;
+            arena[off++] = '\0';
+            ++arena[argc_off];
+        }
+    }
+    if (steps == 0) {
+        return lwshellERRPAR;
+    }
+    arena[steps_off] = (char)steps;
+    lwobj->aliases_len = (uint16_t)off;
+    if (old_off < start) {
+        prv_alias_remove(lwobj, old_off); /* Remove replaced alias, new entry moves down */
+    }
+    return lwshellOK;
+}
+
+#if LWSHELL_CFG_USE_PERMISSIONS
+
+/**
+ * \brief           Check if session may run all commands of the alias
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       entry: Pointer to alias entry
+ * \return          `1` if all commands are allowed, `0` otherwise
+ */
+static uint8_t
+prv_alias_allowed(lwshell_t* lwobj, const char* entry) {
+    const char* ptr = entry + strlen(entry) + 1;
+    uint8_t steps = (uint8_t)*ptr++;
+
+    for (; steps > 0; --steps) {
+        uint8_t argc = (uint8_t)*ptr++;
+        const lwshell_cmd_t* ccmd = prv_find_cmd(lwobj, ptr, strlen(ptr), 0);
+
+        if (ccmd != NULL && !LWSHELL_CMD_ALLOWED(lwobj, ccmd)) {
+            return 0;
+        }
+        for (; argc > 0; --argc) {
+            ptr += strlen(ptr) + 1;
+        }
+    }
+    return 1;
+}
+
+#endif /* LWSHELL_CFG_USE_PERMISSIONS */
+
+/**
+ * \brief           Print all aliases with their definitions.
+ *
+ * Aliases with commands not allowed to the session are skipped
+ *
+ * \param[in]       lwobj: LwSHELL instance
+ */
+static void
+prv_alias_list(lwshell_t* lwobj) {
+    for (size_t off = 0; off < lwobj->aliases_len; off += prv_alias_entry_len(&lwobj->aliases[off])) {
+        const char* ptr = &lwobj->aliases[off];
+        uint8_t steps;
+
+#if LWSHELL_CFG_USE_PERMISSIONS
+        if (!prv_alias_allowed(lwobj, ptr)) {
+            continue;
+        }
+#endif /* LWSHELL_CFG_USE_PERMISSIONS */
+        LWSHELL_OUTPUT(lwobj, ptr);
+        LWSHELL_OUTPUT(lwobj, "\t\t\t");
+        ptr += strlen(ptr) + 1;
+        for (steps = (uint8_t)*ptr++; steps > 0; --steps) {
+            for (uint8_t argc = (uint8_t)*ptr++; argc > 0; --argc) {
+                LWSHELL_OUTPUT(lwobj, ptr);
+                LWSHELL_OUTPUT(lwobj, argc > 1 ? " " : (steps > 1 ? "; " : ""));
+                ptr += strlen(ptr) + 1;
+            }
+        }
+        LWSHELL_OUTPUT(lwobj, LWSHELL_CFG_NEWLINE);
+    }
+}
+
+/**
+ * \brief           Built-in `alias` command to define, delete or list aliases
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ */
+static void
+prv_alias_cmd(lwshell_t* lwobj, size_t argc, char** argv) {
+    if (argc == 1U) {
+        prv_alias_list(lwobj);
+    } else if (prv_alias_define(lwobj, argv[1], argc - 2U, (const char* const*)&argv[2]) != lwshellOK) {
+        LWSHELL_OUTPUT(lwobj, "Cannot set alias" LWSHELL_CFG_NEWLINE);
+    }
+}
+
+/**
+ * \brief           Execute input line as alias, if first word is alias name.
+ *
+ * Stored commands are dispatched without tokenization.
+ * Only additional arguments after alias name are tokenized
+ * and appended to the last command of the alias.
+ *
+ * \param[in]       lwobj: LwSHELL instance
+ * \return          `1` if line has been processed as alias, `0` otherwise
+ */
+static uint8_t
+prv_alias_exec(lwshell_t* lwobj) {
+    char* argv[LWSHELL_CFG_MAX_CMD_ARGS];
+    char* extra_argv[LWSHELL_CFG_MAX_CMD_ARGS];
+    char *name = lwobj->buff, *name_end;
+    size_t off;
+    uint8_t steps, locked = lwobj->aliases_locked;
+
+    while (*name == ' ') {
+        ++name;
+    }
+    for (name_end = name; *name_end != ' ' && *name_end != '\0'; ++name_end) {}
+    if ((off = prv_alias_find(lwobj, name, (size_t)(name_end - name))) >= lwobj->aliases_len
+        || prv_alias_reserved(lwobj, name, (size_t)(name_end - name))) {
+        return 0; /* Not an alias, or command registered later with the same name */
+    }
+
+    /* Tokenize additional arguments only */
+    prv_tokenize(lwobj, name_end);
+    prv_get_args(lwobj, extra_argv);
+
+    off += strlen(&lwobj->aliases[off]) + 1;
+    lwobj->aliases_locked = 1;
+    for (steps = (uint8_t)lwobj->aliases[off++]; steps > 0; --steps) {
+        const lwshell_cmd_t* ccmd;
+        size_t argc = (uint8_t)lwobj->aliases[off++];
+
+        for (size_t idx = 0; idx < argc; ++idx) {
+            argv[idx] = &lwobj->aliases[off];
+            off += strlen(argv[idx]) + 1;
+#if LWSHELL_CFG_USE_VARS
+            if (idx > 0) { /* Command name is never expanded */
+                argv[idx] = prv_var_expand(lwobj, argv[idx]);
+            }
+#endif /* LWSHELL_CFG_USE_VARS */
+        }
+        if (steps == 1U) {
+            for (size_t idx = 0; idx < (size_t)lwobj->argc && argc < LWSHELL_CFG_MAX_CMD_ARGS; ++idx) {
+                argv[argc++] = extra_argv[idx];
+            }
+        }
+        if ((ccmd = prv_find_cmd(lwobj, argv[0], strlen(argv[0]), 1)) != NULL) {
+            prv_exec_cmd(lwobj, ccmd, argc, argv);
+        } else {
+            LWSHELL_OUTPUT(lwobj, "Unknown command" LWSHELL_CFG_NEWLINE);
+            LWSHELL_SET_RESULT(lwobj, lwshellSTATUS_UNKNOWN_CMD, 0);
+        }
+    }
+    lwobj->aliases_locked = locked;
+    return 1;
+}
+
+#endif /* LWSHELL_CFG_USE_ALIAS */
+
+#if LWSHELL_CFG_USE_RESULT
+
+/**
+ * \brief           Complete result of processed line and notify application
+ * \param[in]       lwobj: LwSHELL instance
+ */
+static void
+prv_result_report(lwshell_t* lwobj) {
+    lwobj->result.flags = lwobj->line_flags;
+    if (lwobj->result_fn != NULL) {
+        lwobj->result_fn(&lwobj->result, lwobj);
+    }
+}
+
+#endif /* LWSHELL_CFG_USE_RESULT */
+
+/**
+ * \brief           Parse input string
+ * \param[in]       lwobj: LwSHELL instance
+ */
+static void
+prv_parse_input(lwshell_t* lwobj) {
+    char* argv[LWSHELL_CFG_MAX_CMD_ARGS];
+    size_t s_len;
+
+#if LWSHELL_CFG_USE_ALLOC
+    /* Buffer may not be allocated yet */
+    if (lwobj->buff_ptr == 0) {
+        return;
+    }
+#endif /* LWSHELL_CFG_USE_ALLOC */
+
+    /* Check string length and compare with buffer pointer */
+    s_len = strlen(lwobj->buff);
+    if (s_len != lwobj->buff_ptr) {
+        return;
+    }
+
+    /* Must be more than `1` character since we have to include end of line */
+    if (lwobj->buff_ptr > 0) {
+#if LWSHELL_CFG_USE_ALIAS
+        if (prv_alias_exec(lwobj)) {
+#if LWSHELL_CFG_USE_RESULT
+            prv_result_report(lwobj);
+#endif /* LWSHELL_CFG_USE_RESULT */
+            return;
+        }
+#endif /* LWSHELL_CFG_USE_ALIAS */
+
+        /* Process complete input */
+        prv_tokenize(lwobj, lwobj->buff);
+
+        /* Check for command */
+        if (lwobj->argc > 0) {
+            const lwshell_cmd_t* ccmd;
+
+            prv_get_args(lwobj, argv);
+            ccmd = prv_find_cmd(lwobj, argv[0], strlen(argv[0]), 1);
+
+            /* Valid command ready? */
+            if (ccmd != NULL) {
+                prv_exec_cmd(lwobj, ccmd, lwobj->argc, argv);
+#if LWSHELL_CFG_USE_LIST_CMD
+            } else if (strncmp(argv[0], "listcmd", 7U) == 0) {
+                LWSHELL_OUTPUT(lwobj, "List of registered commands" LWSHELL_CFG_NEWLINE);
+#if LWSHELL_CFG_USE_DYNAMIC_COMMANDS
+                for (size_t idx = 0; idx < lwobj->dynamic_cmds_cnt; ++idx) {
+                    if (!LWSHELL_CMD_ALLOWED(lwobj, &lwobj->dynamic_cmds[idx])) {
+                        continue;
+                    }
+                    LWSHELL_OUTPUT(lwobj, lwobj->dynamic_cmds[idx].name);
+                    LWSHELL_OUTPUT(lwobj, "\t\t\t");
+                    LWSHELL_OUTPUT(lwobj, lwobj->dynamic_cmds[idx].desc);
+                    LWSHELL_OUTPUT(lwobj, LWSHELL_CFG_NEWLINE);
+                }
+#endif /* LWSHELL_CFG_USE_DYNAMIC_COMMANDS */
+#if LWSHELL_CFG_USE_STATIC_COMMANDS
+                for (size_t idx = 0; idx < lwobj->static_cmds_cnt; ++idx) {
+                    if (!LWSHELL_CMD_ALLOWED(lwobj, &lwobj->static_cmds[idx])) {
+                        continue;
+                    }
+                    LWSHELL_OUTPUT(lwobj, lwobj->static_cmds[idx].name);
+                    LWSHELL_OUTPUT(lwobj, "\t\t\t");
+                    LWSHELL_OUTPUT(lwobj, lwobj->static_cmds[idx].desc);
+                    LWSHELL_OUTPUT(lwobj, LWSHELL_CFG_NEWLINE);
+                }
+#endif /* LWSHELL_CFG_USE_STATIC_COMMANDS */
+#if LWSHELL_CFG_USE_ALIAS
+                prv_alias_list(lwobj);
+#endif /* LWSHELL_CFG_USE_ALIAS */
+                LWSHELL_SET_RESULT(lwobj, lwshellSTATUS_BUILTIN, 0);
+#endif /* LWSHELL_CFG_USE_LIST_CMD */
+#if LWSHELL_CFG_USE_VARS
+            } else if (strcmp(argv[0], "set") == 0) {
+                prv_set_cmd(lwobj, lwobj->argc, argv);
+                LWSHELL_SET_RESULT(lwobj, lwshellSTATUS_BUILTIN, 0);
+#endif /* LWSHELL_CFG_USE_VARS */
+#if LWSHELL_CFG_USE_PERMISSIONS
+            } else if (lwobj->login_fn != NULL && strcmp(argv[0], "login") == 0) {
+                lwobj->perm = lwobj->login_fn(lwobj, (int32_t)lwobj->argc, argv);
+                LWSHELL_SET_RESULT(lwobj, lwshellSTATUS_BUILTIN, 0);
+#endif /* LWSHELL_CFG_USE_PERMISSIONS */
+#if LWSHELL_CFG_USE_ALIAS
+            } else if (strcmp(argv[0], "alias") == 0) {
+                prv_alias_cmd(lwobj, lwobj->argc, argv);
+                LWSHELL_SET_RESULT(lwobj, lwshellSTATUS_BUILTIN, 0);
+#endif /* LWSHELL_CFG_USE_ALIAS */
+            } else {
+                LWSHELL_OUTPUT(lwobj, "Unknown command" LWSHELL_CFG_NEWLINE);
+                LWSHELL_SET_RESULT(lwobj, lwshellSTATUS_UNKNOWN_CMD, 0);
+            }
+#if LWSHELL_CFG_USE_RESULT
+            prv_result_report(lwobj);
+#endif /* LWSHELL_CFG_USE_RESULT */
+        }
+    }
+}
+
+/**
+ * \brief           Initialize shell interface
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ */
+lwshellr_t
+lwshell_init_ex(lwshell_t* lwobj) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    LWSHELL_MEMSET(lwobj, 0x00, sizeof(*lwobj));
+    return lwshellOK;
+}
+
+#if LWSHELL_CFG_USE_ALLOC || __DOXYGEN__
+
+/**
+ * \brief           Release memory allocated by shell interface
+ *
+ * Instance must be initialized again with \ref lwshell_init_ex before it is used again
+ *
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_ALLOC is enabled
+ */
+lwshellr_t
+lwshell_deinit_ex(lwshell_t* lwobj) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    LWSHELL_FREE(lwobj->buff);
+#if LWSHELL_CFG_USE_DYNAMIC_COMMANDS
+    LWSHELL_FREE(lwobj->dynamic_cmds);
+#endif /* LWSHELL_CFG_USE_DYNAMIC_COMMANDS */
+    LWSHELL_MEMSET(lwobj, 0x00, sizeof(*lwobj));
+    return lwshellOK;
+}
+
+#endif /* LWSHELL_CFG_USE_ALLOC || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_OUTPUT || __DOXYGEN__
+
+/**
+ * \brief           Set output function to use to print data from library to user
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       out_fn: Output function to print library data.
+ *                      Set to `NULL` to disable the feature
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ */
+lwshellr_t
+lwshell_set_output_fn_ex(lwshell_t* lwobj, lwshell_output_fn out_fn) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    lwobj->out_fn = out_fn;
+    return lwshellOK;
+}
+
+#endif /* LWSHELL_CFG_USE_OUTPUT || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_PRINTF || LWSHELL_CFG_USE_STRUCTURED_OUTPUT || __DOXYGEN__
+
+/**
+ * \brief           Get instance currently executing command function.
+ *
+ * Command functions shared by multiple instances can use it
+ * to call `_ex` functions with explicit instance instead of `NULL`.
+ *
+ * \note            Pointer is process-wide, unless \ref LWSHELL_CFG_THREAD_LOCAL is set.
+ *                  Commands of different instances must not be processed concurrently otherwise
+ * \return          Instance executing command, `NULL` when called outside of command function
+ * \note            Available only when \ref LWSHELL_CFG_USE_PRINTF
+ *                  or \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+lwshell_t*
+lwshell_get_current_ex(void) {
+    return shell_current;
+}
+
+/* Format flags */
+#define LWSHELL_PRINTF_FLAG_LEFT  0x01 /*!< Left-align field, `-` */
+#define LWSHELL_PRINTF_FLAG_ZERO  0x02 /*!< Pad numbers with zeros, `0` */
+#define LWSHELL_PRINTF_FLAG_PLUS  0x04 /*!< Always print sign, `+` */
+#define LWSHELL_PRINTF_FLAG_SPACE 0x08 /*!< Print space instead of `+` sign, ` ` */
+#define LWSHELL_PRINTF_FLAG_UPPER 0x10 /*!< Use uppercase hex digits */
+
+/* Maximal `%f` precision, rounded exactly with double arithmetic */
+#define LWSHELL_PRINTF_FLOAT_MAX_PREC 15U
+
+/**
+ * \brief           Formatter output context, collecting characters to small chunk
+ */
+typedef struct {
+    lwshell_t* lwobj;                              /*!< Instance to output to */
+    size_t len;                                    /*!< Total number of formatted characters */
+    size_t ptr;                                    /*!< Number of characters in chunk buffer */
+    char buff[LWSHELL_CFG_PRINTF_CHUNK_SIZE + 1U]; /*!< Chunk buffer, including null-termination */
+} prv_printf_ctx_t;
+
+/**
+ * \brief           Send collected chunk to output function
+ * \param[in]       ctx: Formatter context
+ */
+static void
+prv_printf_flush(prv_printf_ctx_t* ctx) {
+    if (ctx->ptr > 0) {
+        ctx->buff[ctx->ptr] = '\0';
+        LWSHELL_OUTPUT(ctx->lwobj, ctx->buff);
+        ctx->ptr = 0;
+    }
+}
+
+/**
+ * \brief           Output character `cnt` times
+ * \param[in]       ctx: Formatter context
+ * \param[in]       ch: Character to output
+ * \param[in]       cnt: Number of repetitions
+ */
+static void
+prv_printf_ch(prv_printf_ctx_t* ctx, char ch, size_t cnt) {
+    for (; cnt > 0; --cnt) {
+        ctx->buff[ctx->ptr++] = ch;
+        ++ctx->len;
+        if (ctx->ptr == LWSHELL_CFG_PRINTF_CHUNK_SIZE) {
+            prv_printf_flush(ctx);
+        }
+    }
+}
+
+/**
+ * \brief           Convert unsigned number to digits, written backwards from the end of buffer
+ * \param[in]       num: Number to convert
+ * \param[in]       base: Number base, `8`, `10` or `16`
+ * \param[in]       flags: Format flags
+ * \param[in]       end: Pointer to the end of buffer, large enough for all digits
+ * \return          Pointer to the first digit
+ */
+static char*
+prv_printf_utoa(unsigned long long num, unsigned base, uint8_t flags, char* end) {
+    const char* digits = (flags & LWSHELL_PRINTF_FLAG_UPPER) ? "0123456789ABCDEF" : "0123456789abcdef";
+
+    do {
+        *--end = digits[num % base];
+        num /= base;
+    } while (num > 0);
+    return end;
+}
+
+#endif /* LWSHELL_CFG_USE_PRINTF || LWSHELL_CFG_USE_STRUCTURED_OUTPUT || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_PRINTF || __DOXYGEN__
+
+/**
+ * \brief           Output beginning of the field, padding and optional sign prefix
+ * \param[in]       ctx: Formatter context
+ * \param[in]       sign: Sign character or `0` if none
+ * \param[in]       str_len: Number of field characters, following the sign
+ * \param[in]       width: Minimum field width
+ * \param[in]       flags: Format flags
+ * \return          Number of spaces to output after field characters
+ */
+static size_t
+prv_printf_field_begin(prv_printf_ctx_t* ctx, char sign, size_t str_len, size_t width, uint8_t flags) {
+    size_t pad = str_len + (sign ? 1U : 0U) < width ? width - str_len - (sign ? 1U : 0U) : 0;
+
+    if (!(flags & (LWSHELL_PRINTF_FLAG_LEFT | LWSHELL_PRINTF_FLAG_ZERO))) {
+        prv_printf_ch(ctx, ' ', pad);
+    }
+    if (sign) {
+        prv_printf_ch(ctx, sign, 1);
+    }
+    if ((flags & (LWSHELL_PRINTF_FLAG_LEFT | LWSHELL_PRINTF_FLAG_ZERO)) == LWSHELL_PRINTF_FLAG_ZERO) {
+        prv_printf_ch(ctx, '0', pad);
+    }
+    return (flags & LWSHELL_PRINTF_FLAG_LEFT) ? pad : 0;
+}
+
+/**
+ * \brief           Output field with optional sign prefix, padded to width
+ * \param[in]       ctx: Formatter context
+ * \param[in]       sign: Sign character or `0` if none
+ * \param[in]       str: Field characters
+ * \param[in]       str_len: Number of field characters
+ * \param[in]       width: Minimum field width
+ * \param[in]       flags: Format flags
+ */
+static void
+prv_printf_field(prv_printf_ctx_t* ctx, char sign, const char* str, size_t str_len, size_t width, uint8_t flags) {
+    size_t pad = prv_printf_field_begin(ctx, sign, str_len, width, flags);
+
+    for (size_t idx = 0; idx < str_len; ++idx) {
+        prv_printf_ch(ctx, str[idx], 1);
+    }
+    prv_printf_ch(ctx, ' ', pad);
+}
+
+/**
+ * \brief           Get sign character for number
+ * \param[in]       neg: Set to `1` for negative number
+ * \param[in]       flags: Format flags
+ * \return          Sign character or `0` if none
+ */
+static char
+prv_printf_sign(uint8_t neg, uint8_t flags) {
+    return neg ? '-' : ((flags & LWSHELL_PRINTF_FLAG_PLUS) ? '+' : ((flags & LWSHELL_PRINTF_FLAG_SPACE) ? ' ' : 0));
+}
+
+#if LWSHELL_CFG_PRINTF_FLOAT || __DOXYGEN__
+
+/**
+ * \brief           Get rounding error of floating point product, with Dekker's algorithm
+ * \param[in]       a: First factor
+ * \param[in]       b: Second factor
+ * \param[in]       p: Rounded product of `a` and `b`
+ * \return          Exact difference between real product and `p`
+ */
+static double
+prv_printf_mul_err(double a, double b, double p) {
+    double ca = 134217729.0 * a, cb = 134217729.0 * b; /* Split factors to halves of 26 bits */
+    double ah = ca - (ca - a), al = a - ah, bh = cb - (cb - b), bl = b - bh;
+
+    return ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+}
+
+/**
+ * \brief           Output positive integral floating point number too large for integer type, `%f` specifier.
+ *
+ * Number is `m * 2^e`, converted exactly to base `10^9` digits with repeated multiplication.
+ *
+ * \param[in]       ctx: Formatter context
+ * \param[in]       num: Number to output, at least `2^64`
+ * \param[in]       sign: Sign character or `0` if none
+ * \param[in]       prec: Number of decimal places, all zero
+ * \param[in]       width: Minimum field width
+ * \param[in]       flags: Format flags
+ */
+static void
+prv_printf_float_big(prv_printf_ctx_t* ctx, double num, char sign, size_t prec, size_t width, uint8_t flags) {
+    uint32_t limbs[35]; /* Up to 315 digits, largest double has 309 */
+    char tmp[10], *str;
+    unsigned long long val;
+    size_t cnt = 0, len, pad;
+    unsigned exp = 0;
+
+    /* Halving is exact, number stays integral down to 2^53 */
+    for (; num >= 9007199254740992.0; num /= 2) {
+        ++exp;
+    }
+    for (val = (unsigned long long)num; val > 0; val /= 1000000000U) {
+        limbs[cnt++] = (uint32_t)(val % 1000000000U);
+    }
+    while (exp > 0) {
+        unsigned shift = exp > 29U ? 29U : exp;
+
+        val = 0;
+        for (size_t idx = 0; idx < cnt; ++idx) {
+            val += (unsigned long long)limbs[idx] << shift;
+            limbs[idx] = (uint32_t)(val % 1000000000U);
+            val /= 1000000000U;
+        }
+        if (val > 0) {
+            limbs[cnt++] = (uint32_t)val;
+        }
+        exp -= shift;
+    }
+
+    /* Most significant limb without leading zeros, all others with 9 digits */
+    str = prv_printf_utoa(limbs[cnt - 1U], 10, 0, &tmp[sizeof(tmp)]);
+    len = (size_t)(&tmp[sizeof(tmp)] - str) + 9U * (cnt - 1U) + (prec > 0 ? prec + 1U : 0);
+    pad = prv_printf_field_begin(ctx, sign, len, width, flags);
+    for (; str < &tmp[sizeof(tmp)]; ++str) {
+        prv_printf_ch(ctx, *str, 1);
+    }
+    for (size_t idx = cnt - 1U; idx > 0; --idx) {
+        str = prv_printf_utoa(limbs[idx - 1U], 10, 0, &tmp[sizeof(tmp)]);
+        prv_printf_ch(ctx, '0', (size_t)(str - &tmp[1]));
+        for (; str < &tmp[sizeof(tmp)]; ++str) {
+            prv_printf_ch(ctx, *str, 1);
+        }
+    }
+    if (prec > 0) {
+        prv_printf_ch(ctx, '.', 1);
+        prv_printf_ch(ctx, '0', prec);
+    }
+    prv_printf_ch(ctx, ' ', pad);
+}
+
+/**
+ * \brief           Output floating point number in fixed-point notation, `%f` specifier
+ * \param[in]       ctx: Formatter context
+ * \param[in]       num: Number to output
+ * \param[in]       prec: Number of decimal places, up to \ref LWSHELL_PRINTF_FLOAT_MAX_PREC
+ * \param[in]       width: Minimum field width
+ * \param[in]       flags: Format flags
+ */
+static void
+prv_printf_float(prv_printf_ctx_t* ctx, double num, size_t prec, size_t width, uint8_t flags) {
+    char tmp[40], *str = &tmp[sizeof(tmp)];
+    unsigned long long ipart, fpart, scale = 1;
+    double frac, frac_scaled, rem;
+    uint8_t neg = num < 0, round_up;
+
+    if (num != num) {
+        prv_printf_field(ctx, 0, "nan", 3, width, flags & ~LWSHELL_PRINTF_FLAG_ZERO);
+        return;
+    }
+    num = neg ? -num : num;
+    if (num > DBL_MAX) {
+        prv_printf_field(ctx, prv_printf_sign(neg, flags), "inf", 3, width, flags & ~LWSHELL_PRINTF_FLAG_ZERO);
+        return;
+    }
+    if (prec > LWSHELL_PRINTF_FLOAT_MAX_PREC) { /* Digits cannot be exact, mark value as missing */
+        prv_printf_field(ctx, 0, "?", 1, width, flags & LWSHELL_PRINTF_FLAG_LEFT);
+        return;
+    }
+    if (num >= 18446744073709551616.0) { /* Integer part does not fit to integer type */
+        prv_printf_float_big(ctx, num, prv_printf_sign(neg, flags), prec, width, flags);
+        return;
+    }
+
+    /* Split to integer and rounded fractional part */
+    for (size_t idx = 0; idx < prec; ++idx) {
+        scale *= 10U;
+    }
+    ipart = (unsigned long long)num;
+    frac = num - (double)ipart;
+    frac_scaled = frac * (double)scale;
+    fpart = (unsigned long long)frac_scaled;
+    rem = frac_scaled - (double)fpart;
+    if (rem == 0.5) {
+        /* Product may be rounded to the tie, exact ties round to even digit, as libc does */
+        double err = prv_printf_mul_err(frac, (double)scale, frac_scaled);
+        round_up = err > 0 || (err == 0 && ((prec > 0 ? fpart : ipart) & 1U));
+    } else {
+        round_up = rem > 0.5;
+    }
+    if (round_up) {
+        ++fpart;
+    }
+    if (fpart >= scale) {
+        ++ipart;
+        fpart -= scale;
+    }
+
+    /* Build digits backwards */
+    if (prec > 0) {
+        char* frac = prv_printf_utoa(fpart, 10, 0, str);
+
+        while ((size_t)(str - frac) < prec) {
+            *--frac = '0';
+        }
+        str = frac;
+        *--str = '.';
+    }
+    str = prv_printf_utoa(ipart, 10, 0, str);
+    prv_printf_field(ctx, prv_printf_sign(neg, flags), str, (size_t)(&tmp[sizeof(tmp)] - str), width, flags);
+}
+
+#endif /* LWSHELL_CFG_PRINTF_FLOAT || __DOXYGEN__ */
+
+/**
+ * \brief           Print formatted string through instance output function, using variable argument list
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use the instance
+ *                      currently executing command function, or default one
+ * \param[in]       fmt: Format string
+ * \param[in]       args: Variable argument list
+ * \return          Number of formatted characters
+ * \note            Available only when \ref LWSHELL_CFG_USE_PRINTF is enabled
+ */
+size_t
+lwshell_vprintf_ex(lwshell_t* lwobj, const char* fmt, va_list args) {
+    prv_printf_ctx_t ctx;
+
+    ctx.lwobj = LWSHELL_GET_LWOBJ_CUR(lwobj);
+    ctx.len = 0;
+    ctx.ptr = 0;
+    if (ctx.lwobj->out_fn == NULL || fmt == NULL) {
+        return 0;
+    }
+    for (; *fmt != '\0'; ++fmt) {
+        char tmp[24], *str;
+        size_t width = 0, prec = SIZE_MAX;
+        unsigned long long num;
+        uint8_t flags = 0, lmod = 0, neg = 0;
+        unsigned base = 10;
+
+        if (*fmt != '%') {
+            prv_printf_ch(&ctx, *fmt, 1);
+            continue;
+        }
+
+        /* Flags */
+        for (++fmt;; ++fmt) {
+            if (*fmt == '-') {
+                flags |= LWSHELL_PRINTF_FLAG_LEFT;
+            } else if (*fmt == '0') {
+                flags |= LWSHELL_PRINTF_FLAG_ZERO;
+            } else if (*fmt == '+') {
+                flags |= LWSHELL_PRINTF_FLAG_PLUS;
+            } else if (*fmt == ' ') {
+                flags |= LWSHELL_PRINTF_FLAG_SPACE;
+            } else {
+                break;
+            }
+        }
+
+        /* Width and precision */
+        if (*fmt == '*') {
+            int val = va_arg(args, int);
+            if (val < 0) { /* Negative width left-aligns, `INT_MIN` cannot be negated */
+                flags |= LWSHELL_PRINTF_FLAG_LEFT;
+                val = val == INT_MIN ? INT_MAX : -val;
+            }
+            width = (size_t)val;
+            ++fmt;
+        }
+        for (; *fmt >= '0' && *fmt <= '9'; ++fmt) {
+            width = width * 10U + (size_t)(*fmt - '0');
+        }
+        if (*fmt == '.') {
+            prec = 0;
+            if (*++fmt == '*') {
+                int val = va_arg(args, int);
+                prec = val < 0 ? SIZE_MAX : (size_t)val;
+                ++fmt;
+            }
+            for (; *fmt >= '0' && *fmt <= '9'; ++fmt) {
+                prec = prec * 10U + (size_t)(*fmt - '0');
+            }
+        }
+
+        /* Length modifiers, `1` for long, `2` for long long, `3` for size_t */
+        for (;; ++fmt) {
+            if (*fmt == 'l') {
+                ++lmod;
+            } else if (*fmt == 'z') {
+                lmod = 3;
+            } else if (*fmt != 'h') { /* Short types are promoted to int */
+                break;
+            }
+        }
+
+        switch (*fmt) {
+            case 'd':
+            case 'i': {
+                long long val = lmod == 0   ? va_arg(args, int)
+                                : lmod == 1 ? va_arg(args, long)
+                                : lmod == 2 ? va_arg(args, long long)
+                                            : (long long)va_arg(args, size_t);
+                neg = val < 0;
+                num = neg ? 0ULL - (unsigned long long)val : (unsigned long long)val;
+                break;
+            }
+            case 'X': flags |= LWSHELL_PRINTF_FLAG_UPPER; /* fallthrough */
+            case 'x': base = 16; /* fallthrough */
+            case 'o': base = base == 10 ? 8 : base; /* fallthrough */
+            case 'u':
+                flags &= ~(LWSHELL_PRINTF_FLAG_PLUS | LWSHELL_PRINTF_FLAG_SPACE);
+                num = lmod == 0   ? va_arg(args, unsigned int)
+                      : lmod == 1 ? va_arg(args, unsigned long)
+                      : lmod == 2 ? va_arg(args, unsigned long long)
+                                  : va_arg(args, size_t);
+                break;
+            case 'p':
+                flags = (uint8_t)((flags & LWSHELL_PRINTF_FLAG_LEFT) | LWSHELL_PRINTF_FLAG_UPPER);
+                base = 16;
+                num = (unsigned long long)(uintptr_t)va_arg(args, void*);
+                break;
+            case 'c':
+                tmp[0] = (char)va_arg(args, int);
+                prv_printf_field(&ctx, 0, tmp, 1, width, flags & LWSHELL_PRINTF_FLAG_LEFT);
+                continue;
+            case 's': {
+                const char* arg = va_arg(args, const char*);
+                size_t arg_len = 0;
+
+                arg = arg != NULL ? arg : "(null)";
+                while (arg_len < prec && arg[arg_len] != '\0') { /* Precision limits string length */
+                    ++arg_len;
+                }
+                prv_printf_field(&ctx, 0, arg, arg_len, width, flags & LWSHELL_PRINTF_FLAG_LEFT);
+                continue;
+            }
+            case 'f':
+            case 'F': {
+                double val = va_arg(args, double);
+#if LWSHELL_CFG_PRINTF_FLOAT
+                prv_printf_float(&ctx, val, prec == SIZE_MAX ? 6U : prec, width, flags);
+#else
+                (void)val; /* Argument is consumed, placeholder marks missing value */
+                prv_printf_field(&ctx, 0, "?", 1, width, flags & LWSHELL_PRINTF_FLAG_LEFT);
+#endif /* LWSHELL_CFG_PRINTF_FLOAT */
+                continue;
+            }
+            case '\0': --fmt; continue; /* Incomplete specifier at the end of string */
+            default: prv_printf_ch(&ctx, *fmt, 1); continue; /* Includes `%%` */
+        }
+
+        /* Integer conversions */
+        str = prv_printf_utoa(num, base, flags, &tmp[sizeof(tmp)]);
+        if (prec != SIZE_MAX) { /* Precision sets minimum number of digits, zero flag is ignored */
+            flags &= ~LWSHELL_PRINTF_FLAG_ZERO;
+            if (prec == 0 && num == 0) {
+                str = &tmp[sizeof(tmp)];
+            }
+            while ((size_t)(&tmp[sizeof(tmp)] - str) < prec && str > &tmp[0]) {
+                *--str = '0';
+            }
+        }
+        prv_printf_field(&ctx, prv_printf_sign(neg, flags), str, (size_t)(&tmp[sizeof(tmp)] - str), width, flags);
+    }
+    prv_printf_flush(&ctx);
+    return ctx.len;
+}
+
+/**
+ * \brief           Print formatted string through instance output function.
+ *
+ * Output is formatted to a small chunk buffer of \ref LWSHELL_CFG_PRINTF_CHUNK_SIZE characters,
+ * sent to output function every time it gets full. No heap memory is used.
+ *
+ * Supported specifiers are `d`, `i`, `u`, `x`, `X`, `o`, `c`, `s`, `p` and `%`,
+ * with flags `-`, `0`, `+`, space, width, precision (also as `*`) and `h`, `l`, `ll`, `z` length modifiers.
+ * `f` is supported when \ref LWSHELL_CFG_PRINTF_FLOAT is enabled, rounded to nearest with ties to even, as libc does.
+ * Precision is limited to `15` digits, `?` is printed in place of value with larger precision.
+ * When disabled, `?` is printed in place of floating point value.
+ *
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use the instance
+ *                      currently executing command function, or default one
+ * \param[in]       fmt: Format string
+ * \return          Number of formatted characters
+ * \note            Available only when \ref LWSHELL_CFG_USE_PRINTF is enabled
+ */
+size_t
+lwshell_printf_ex(lwshell_t* lwobj, const char* fmt, ...) {
+    va_list args;
+    size_t len;
+
+    va_start(args, fmt);
+    len = lwshell_vprintf_ex(lwobj, fmt, args);
+    va_end(args);
+    return len;
+}
+
+#endif /* LWSHELL_CFG_USE_PRINTF || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_STRUCTURED_OUTPUT || __DOXYGEN__
+
+/**
+ * \brief           Get instance for structured output
+ * \param[in]       lwobj: LwSHELL object instance or `NULL`
+ * \return          Instance to emit data to, `NULL` if its output function is not set
+ */
+static lwshell_t*
+prv_emit_get_lwobj(lwshell_t* lwobj) {
+    lwobj = LWSHELL_GET_LWOBJ_CUR(lwobj);
+    return lwobj->out_fn != NULL ? lwobj : NULL;
+}
+
+/**
+ * \brief           Initialize formatter context for structured output
+ * \param[out]      ctx: Formatter context
+ * \param[in]       lwobj: LwSHELL object instance or `NULL`
+ * \return          `1` if output function is set and data shall be emitted, `0` otherwise
+ */
+static uint8_t
+prv_emit_init(prv_printf_ctx_t* ctx, lwshell_t* lwobj) {
+    ctx->lwobj = prv_emit_get_lwobj(lwobj);
+    ctx->len = 0;
+    ctx->ptr = 0;
+    return ctx->lwobj != NULL;
+}
+
+/**
+ * \brief           Output string, escaped for JSON string when `esc` is set
+ * \param[in]       ctx: Formatter context
+ * \param[in]       str: Null-terminated string to output
+ * \param[in]       esc: Set to `1` to escape quote, backslash and control characters
+ */
+static void
+prv_emit_raw(prv_printf_ctx_t* ctx, const char* str, uint8_t esc) {
+    for (; *str != '\0'; ++str) {
+        uint8_t ch = (uint8_t)*str;
+
+        if (esc && (ch == '"' || ch == '\\')) {
+            prv_printf_ch(ctx, '\\', 1);
+        } else if (esc && ch < 0x20U) {
+            prv_printf_ch(ctx, '\\', 1);
+            prv_printf_ch(ctx, 'u', 1);
+            prv_printf_ch(ctx, '0', 2);
+            prv_printf_ch(ctx, "0123456789abcdef"[ch >> 4], 1);
+            ch = (uint8_t)"0123456789abcdef"[ch & 0x0FU];
+        }
+        prv_printf_ch(ctx, (char)ch, 1);
+    }
+}
+
+/**
+ * \brief           Output field separator and key
+ * \param[in]       ctx: Formatter context
+ * \param[in]       key: Field key
+ */
+static void
+prv_emit_key(prv_printf_ctx_t* ctx, const char* key) {
+    uint8_t json = ctx->lwobj->out_mode == LWSHELL_OUTPUT_MODE_JSON;
+
+    if (ctx->lwobj->emit_fields) {
+        prv_emit_raw(ctx, json ? "," : ", ", 0);
+    }
+    ctx->lwobj->emit_fields = 1;
+    if (json) {
+        prv_printf_ch(ctx, '"', 1);
+        prv_emit_raw(ctx, key, 1);
+        prv_emit_raw(ctx, "\":", 0);
+    } else {
+        prv_emit_raw(ctx, key, 0);
+        prv_emit_raw(ctx, ": ", 0);
+    }
+}
+
+/**
+ * \brief           Set output mode for structured output functions
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       mode: Output mode, member of \ref lwshell_output_mode_t
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+lwshellr_t
+lwshell_set_output_mode_ex(lwshell_t* lwobj, lwshell_output_mode_t mode) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    if (mode != LWSHELL_OUTPUT_MODE_HUMAN && mode != LWSHELL_OUTPUT_MODE_JSON) {
+        return lwshellERRPAR;
+    }
+    lwobj->out_mode = (uint8_t)mode;
+    return lwshellOK;
+}
+
+/**
+ * \brief           Begin new structured output record.
+ *
+ * Record is rendered as single JSON object per line in \ref LWSHELL_OUTPUT_MODE_JSON mode,
+ * or as `key: value` pairs on a single line in \ref LWSHELL_OUTPUT_MODE_HUMAN mode.
+ * Fields are streamed to output function as they are emitted, record is never stored in memory.
+ *
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use the instance
+ *                      currently executing command function, or default one
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+lwshellr_t
+lwshell_emit_begin_ex(lwshell_t* lwobj) {
+    lwobj = prv_emit_get_lwobj(lwobj);
+    if (lwobj != NULL) {
+        lwobj->emit_fields = 0;
+        if (lwobj->out_mode == LWSHELL_OUTPUT_MODE_JSON) {
+            LWSHELL_OUTPUT(lwobj, "{");
+        }
+    }
+    return lwshellOK;
+}
+
+/**
+ * \brief           Emit string field to current record
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use the instance
+ *                      currently executing command function, or default one
+ * \param[in]       key: Field key
+ * \param[in]       value: Null-terminated string value
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+lwshellr_t
+lwshell_emit_str_ex(lwshell_t* lwobj, const char* key, const char* value) {
+    prv_printf_ctx_t ctx;
+
+    if (key == NULL || value == NULL) {
+        return lwshellERRPAR;
+    }
+    if (prv_emit_init(&ctx, lwobj)) {
+        uint8_t json = ctx.lwobj->out_mode == LWSHELL_OUTPUT_MODE_JSON;
+
+        prv_emit_key(&ctx, key);
+        if (json) {
+            prv_printf_ch(&ctx, '"', 1);
+        }
+        prv_emit_raw(&ctx, value, json);
+        if (json) {
+            prv_printf_ch(&ctx, '"', 1);
+        }
+        prv_printf_flush(&ctx);
+    }
+    return lwshellOK;
+}
+
+/**
+ * \brief           Emit integer field to current record
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use the instance
+ *                      currently executing command function, or default one
+ * \param[in]       key: Field key
+ * \param[in]       value: Integer value
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+lwshellr_t
+lwshell_emit_int_ex(lwshell_t* lwobj, const char* key, long long value) {
+    prv_printf_ctx_t ctx;
+
+    if (key == NULL) {
+        return lwshellERRPAR;
+    }
+    if (prv_emit_init(&ctx, lwobj)) {
+        char tmp[24], *str;
+
+        str = prv_printf_utoa(value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value, 10, 0,
+                              &tmp[sizeof(tmp) - 1U]);
+        if (value < 0) {
+            *--str = '-';
+        }
+        tmp[sizeof(tmp) - 1U] = '\0';
+        prv_emit_key(&ctx, key);
+        prv_emit_raw(&ctx, str, 0);
+        prv_printf_flush(&ctx);
+    }
+    return lwshellOK;
+}
+
+/**
+ * \brief           Emit boolean field to current record
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use the instance
+ *                      currently executing command function, or default one
+ * \param[in]       key: Field key
+ * \param[in]       value: Boolean value, `0` for `false`, `true` otherwise
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+lwshellr_t
+lwshell_emit_bool_ex(lwshell_t* lwobj, const char* key, uint8_t value) {
+    prv_printf_ctx_t ctx;
+
+    if (key == NULL) {
+        return lwshellERRPAR;
+    }
+    if (prv_emit_init(&ctx, lwobj)) {
+        prv_emit_key(&ctx, key);
+        prv_emit_raw(&ctx, value ? "true" : "false", 0);
+        prv_printf_flush(&ctx);
+    }
+    return lwshellOK;
+}
+
+/**
+ * \brief           End current structured output record
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use the instance
+ *                      currently executing command function, or default one
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_STRUCTURED_OUTPUT is enabled
+ */
+lwshellr_t
+lwshell_emit_end_ex(lwshell_t* lwobj) {
+    lwobj = prv_emit_get_lwobj(lwobj);
+    if (lwobj != NULL) {
+        LWSHELL_OUTPUT(lwobj,
+                       lwobj->out_mode == LWSHELL_OUTPUT_MODE_JSON ? "}" LWSHELL_CFG_NEWLINE : LWSHELL_CFG_NEWLINE);
+        lwobj->emit_fields = 0;
+    }
+    return lwshellOK;
+}
+
+#endif /* LWSHELL_CFG_USE_STRUCTURED_OUTPUT || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_RESULT || __DOXYGEN__
+
+/**
+ * \brief           Set function called with result of every processed command line.
+ *
+ * Function is called after command completes, for every line with at least one argument.
+ * Empty lines do not produce result.
+ *
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       result_fn: Result function. Set to `NULL` to disable the notification
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_RESULT is enabled
+ */
+lwshellr_t
+lwshell_set_result_fn_ex(lwshell_t* lwobj, lwshell_result_fn result_fn) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    lwobj->result_fn = result_fn;
+    return lwshellOK;
+}
+
+/**
+ * \brief           Get result of last processed command line
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \return          Pointer to result, valid until next line is processed
+ * \note            Available only when \ref LWSHELL_CFG_USE_RESULT is enabled
+ */
+const lwshell_result_t*
+lwshell_get_result_ex(lwshell_t* lwobj) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    return &lwobj->result;
+}
+
+#endif /* LWSHELL_CFG_USE_RESULT || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_PERMISSIONS || __DOXYGEN__
+
+#if LWSHELL_CFG_USE_DYNAMIC_COMMANDS || __DOXYGEN__
+
+/**
+ * \brief           Set permissions required to run dynamic command.
+ *
+ * Session can run the command only when it has been granted all permission bits of the command.
+ * Static commands set permissions in \ref lwshell_cmd_t.perm field instead.
+ *
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       cmd_name: Name of registered dynamic command
+ * \param[in]       perm: Required permission mask, `0` to allow command to everyone
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_PERMISSIONS
+ *                  and \ref LWSHELL_CFG_USE_DYNAMIC_COMMANDS are enabled
+ */
+lwshellr_t
+lwshell_set_cmd_perm_ex(lwshell_t* lwobj, const char* cmd_name, lwshell_perm_t perm) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+
+    if (cmd_name == NULL) {
+        return lwshellERRPAR;
+    }
+    for (size_t idx = 0; idx < lwobj->dynamic_cmds_cnt; ++idx) {
+        if (strcmp(lwobj->dynamic_cmds[idx].name, cmd_name) == 0) {
+            lwobj->dynamic_cmds[idx].perm = perm;
+            return lwshellOK;
         }
     }
+    return lwshellERRPAR;
 }
 
+#endif /* LWSHELL_CFG_USE_DYNAMIC_COMMANDS || __DOXYGEN__ */
+
 /**
- * \brief           Initialize shell interface
+ * \brief           Set permissions granted to the session
  * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       perm: Granted permission mask
  * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_PERMISSIONS is enabled
  */
 lwshellr_t
-lwshell_init_ex(lwshell_t* lwobj) {
-    lwobj = LWSHELL_GET_LWOBJ(NULL);
-    LWSHELL_MEMSET(lwobj, 0x00, sizeof(*lwobj));
+lwshell_set_perm_ex(lwshell_t* lwobj, lwshell_perm_t perm) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    lwobj->perm = perm;
     return lwshellOK;
 }
 
-#if LWSHELL_CFG_USE_OUTPUT || __DOXYGEN__
+/**
+ * \brief           Get permissions granted to the session
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \return          Granted permission mask
+ * \note            Available only when \ref LWSHELL_CFG_USE_PERMISSIONS is enabled
+ */
+lwshell_perm_t
+lwshell_get_perm_ex(lwshell_t* lwobj) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    return lwobj->perm;
+}
 
 /**
- * \brief           Set output function to use to print data from library to user
+ * \brief           Set login function for built-in `login` command.
+ *
+ * Function validates `login` arguments and returns permission mask granted to the session
+ *
  * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
- * \param[in]       out_fn: Output function to print library data.
- *                      Set to `NULL` to disable the feature
+ * \param[in]       login_fn: Login function. Set to `NULL` to disable `login` command
  * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_PERMISSIONS is enabled
  */
 lwshellr_t
-lwshell_set_output_fn_ex(lwshell_t* lwobj, lwshell_output_fn out_fn) {
+lwshell_set_login_fn_ex(lwshell_t* lwobj, lwshell_login_fn login_fn) {
     lwobj = LWSHELL_GET_LWOBJ(lwobj);
-    lwobj->out_fn = out_fn;
+    lwobj->login_fn = login_fn;
     return lwshellOK;
 }
 
-#endif /* LWSHELL_CFG_USE_OUTPUT || __DOXYGEN__ */
+#endif /* LWSHELL_CFG_USE_PERMISSIONS || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_TRANSCRIPT || LWSHELL_CFG_USE_RATE_LIMIT || __DOXYGEN__
+
+/**
+ * \brief           Set time function, used for transcript record timestamps and rate limits
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       time_fn: Time function. Set to `NULL` to record all events with the same time
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_TRANSCRIPT or \ref LWSHELL_CFG_USE_RATE_LIMIT is enabled
+ */
+lwshellr_t
+lwshell_set_time_fn_ex(lwshell_t* lwobj, lwshell_time_fn time_fn) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    lwobj->time_fn = time_fn;
+    return lwshellOK;
+}
+
+#endif /* LWSHELL_CFG_USE_TRANSCRIPT || LWSHELL_CFG_USE_RATE_LIMIT || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_TRANSCRIPT || __DOXYGEN__
+
+/**
+ * \brief           Start or stop transcript recording.
+ *
+ * When started, transcript header is written first, followed by one record
+ * for every registered command, every call to input function and every output string of the instance.
+ * Commands registered later while recording are recorded at registration.
+ * See \ref LWSHELL_TRANSCRIPT_MAGIC for the format description.
+ *
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       transcript_fn: Function receiving transcript data. Set to `NULL` to stop recording
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_TRANSCRIPT is enabled
+ */
+lwshellr_t
+lwshell_set_transcript_fn_ex(lwshell_t* lwobj, lwshell_transcript_fn transcript_fn) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    lwobj->transcript_fn = transcript_fn;
+    if (transcript_fn != NULL) {
+        static const uint8_t hdr[] = LWSHELL_TRANSCRIPT_MAGIC;
+
+        lwobj->transcript_time = lwobj->time_fn != NULL ? lwobj->time_fn(lwobj) : 0;
+        transcript_fn(lwobj, hdr, sizeof(hdr));
+
+        /* Commands in listing order, for replay to register the same ones */
+#if LWSHELL_CFG_USE_DYNAMIC_COMMANDS
+        for (size_t idx = 0; idx < lwobj->dynamic_cmds_cnt; ++idx) {
+            prv_transcript_cmd(lwobj, &lwobj->dynamic_cmds[idx], 0);
+        }
+#endif /* LWSHELL_CFG_USE_DYNAMIC_COMMANDS */
+#if LWSHELL_CFG_USE_STATIC_COMMANDS
+        for (size_t idx = 0; lwobj->static_cmds != NULL && idx < lwobj->static_cmds_cnt; ++idx) {
+            prv_transcript_cmd(lwobj, &lwobj->static_cmds[idx], LWSHELL_TRANSCRIPT_CMD_FLAG_STATIC);
+        }
+#endif /* LWSHELL_CFG_USE_STATIC_COMMANDS */
+    }
+    return lwshellOK;
+}
+
+#endif /* LWSHELL_CFG_USE_TRANSCRIPT || __DOXYGEN__ */
 
 #if LWSHELL_CFG_USE_DYNAMIC_COMMANDS || __DOXYGEN__
 
@@ -274,17 +2058,65 @@ lwshell_register_cmd_ex(lwshell_t* lwobj, const char* cmd_name, lwshell_cmd_fn c
     }
 
     /* Check for memory available */
-    if (lwobj->dynamic_cmds_cnt < LWSHELL_ARRAYSIZE(lwobj->dynamic_cmds)) {
+    if (lwobj->dynamic_cmds_cnt < LWSHELL_DYN_CMDS_SIZE(lwobj) || LWSHELL_DYN_CMDS_GROW(lwobj)) {
         lwobj->dynamic_cmds[lwobj->dynamic_cmds_cnt].name = cmd_name;
         lwobj->dynamic_cmds[lwobj->dynamic_cmds_cnt].fn = cmd_fn;
         lwobj->dynamic_cmds[lwobj->dynamic_cmds_cnt].desc = desc;
 
+#if LWSHELL_CFG_USE_PAYLOAD
+        lwobj->dynamic_cmds[lwobj->dynamic_cmds_cnt].payload_fn = NULL;
+#endif /* LWSHELL_CFG_USE_PAYLOAD */
+#if LWSHELL_CFG_USE_PERMISSIONS
+        lwobj->dynamic_cmds[lwobj->dynamic_cmds_cnt].perm = 0;
+#endif /* LWSHELL_CFG_USE_PERMISSIONS */
+
         ++lwobj->dynamic_cmds_cnt;
+#if LWSHELL_CFG_USE_TRANSCRIPT
+        if (lwobj->transcript_fn != NULL) {
+            prv_transcript_cmd(lwobj, &lwobj->dynamic_cmds[lwobj->dynamic_cmds_cnt - 1], 0);
+        }
+#endif /* LWSHELL_CFG_USE_TRANSCRIPT */
         return lwshellOK;
     }
     return lwshellERRMEM;
 }
 
+#if LWSHELL_CFG_USE_PAYLOAD || __DOXYGEN__
+
+/**
+ * \brief           Register new command with streaming payload to shell
+ *
+ * Everything after command name and first space, until the end of line,
+ * is forwarded to `payload_fn` in chunks as received, without buffering and echo.
+ * Command function `cmd_fn` is called at the end of line, with command name as the only argument.
+ *
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       cmd_name: Command name. This one is used when entering shell command
+ * \param[in]       cmd_fn: Function to call at the end of line
+ * \param[in]       payload_fn: Function to call for every received payload chunk
+ * \param[in]       desc: Custom command description
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_DYNAMIC_COMMANDS
+ *                  and \ref LWSHELL_CFG_USE_PAYLOAD are enabled
+ */
+lwshellr_t
+lwshell_register_payload_cmd_ex(lwshell_t* lwobj, const char* cmd_name, lwshell_cmd_fn cmd_fn,
+                                lwshell_payload_fn payload_fn, const char* desc) {
+    lwshellr_t res;
+
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    if (payload_fn == NULL) {
+        return lwshellERRPAR;
+    }
+    res = lwshell_register_cmd_ex(lwobj, cmd_name, cmd_fn, desc);
+    if (res == lwshellOK) {
+        lwobj->dynamic_cmds[lwobj->dynamic_cmds_cnt - 1].payload_fn = payload_fn;
+    }
+    return res;
+}
+
+#endif /* LWSHELL_CFG_USE_PAYLOAD || __DOXYGEN__ */
+
 #endif /* LWSHELL_CFG_USE_DYNAMIC_COMMANDS || __DOXYGEN__ */
 
 #if LWSHELL_CFG_USE_STATIC_COMMANDS || __DOXYGEN__
@@ -300,61 +2132,432 @@ lwshell_register_cmd_ex(lwshell_t* lwobj, const char* cmd_name, lwshell_cmd_fn c
 lwshellr_t
 lwshell_register_static_cmds_ex(lwshell_t* lwobj, const lwshell_cmd_t* cmds, size_t cmds_len) {
     lwobj = LWSHELL_GET_LWOBJ(lwobj);
+
+#if LWSHELL_CFG_USE_COMPACT_LAYOUT
+    if (cmds_len > UINT16_MAX) {
+        return lwshellERRPAR;
+    }
+#endif /* LWSHELL_CFG_USE_COMPACT_LAYOUT */
     lwobj->static_cmds = cmds;
     lwobj->static_cmds_cnt = cmds_len;
+#if LWSHELL_CFG_USE_TRANSCRIPT
+    for (size_t idx = 0; lwobj->transcript_fn != NULL && cmds != NULL && idx < cmds_len; ++idx) {
+        prv_transcript_cmd(lwobj, &cmds[idx], LWSHELL_TRANSCRIPT_CMD_FLAG_STATIC);
+    }
+#endif /* LWSHELL_CFG_USE_TRANSCRIPT */
     return lwshellOK;
 }
 
 #endif /* LWSHELL_CFG_USE_STATIC_COMMANDS || __DOXYGEN__ */
 
+#if LWSHELL_CFG_USE_VARS || __DOXYGEN__
+
 /**
- * \brief           Input data to shell processing
+ * \brief           Set, overwrite or delete shell variable
+ *
+ * Variables are expanded in command arguments in the form of `$name`,
+ * unless argument is quoted. Only whole arguments are expanded, `x$name` is passed unmodified
+ *
  * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
- * \param[in]       in_data: Input data to process
- * \param[in]       len: Length of data for input
+ * \param[in]       name: Variable name. It must not include space, `"` or `$` characters
+ * \param[in]       value: Variable value. Set to `NULL` to delete variable
  * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_VARS is enabled
  */
 lwshellr_t
-lwshell_input_ex(lwshell_t* lwobj, const void* in_data, size_t len) {
-    const char* p_data = in_data;
+lwshell_set_var_ex(lwshell_t* lwobj, const char* name, const char* value) {
+    size_t slot, empty_slot, name_len, value_len, old_len = 0, off;
+    uint8_t value_in_arena;
+
     lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    if (name == NULL || *name == '\0' || strpbrk(name, " \"$") != NULL) {
+        return lwshellERRPAR;
+    }
 
-    if (in_data == NULL || len == 0) {
+    slot = prv_var_find(lwobj, name, &empty_slot);
+    if (value == NULL) {
+        if (slot < LWSHELL_CFG_VARS_HASH_SIZE) {
+            prv_var_remove(lwobj, lwobj->vars_index[slot] - 1U);
+        }
+        return lwshellOK;
+    }
+
+    /*
+     * Check space before anything is removed, failed overwrite keeps the old value.
+     * Value may come from expansion of another variable and point to the arena,
+     * in this case old and new entries must fit at the same time
+     */
+    value_in_arena = value >= lwobj->vars && value < &lwobj->vars[sizeof(lwobj->vars)];
+    if (slot < LWSHELL_CFG_VARS_HASH_SIZE && !value_in_arena) {
+        old_len = prv_var_entry_len(lwobj, lwobj->vars_index[slot] - 1U);
+    }
+    name_len = strlen(name) + 1;
+    value_len = strlen(value) + 1;
+    if ((slot >= LWSHELL_CFG_VARS_HASH_SIZE && empty_slot >= LWSHELL_CFG_VARS_HASH_SIZE)
+        || (lwobj->vars_len - old_len + name_len + value_len) > sizeof(lwobj->vars)) {
+        return lwshellERRMEM;
+    }
+    if (old_len > 0) {
+        prv_var_remove(lwobj, lwobj->vars_index[slot] - 1U);
+        slot = prv_var_find(lwobj, name, &empty_slot);
+    }
+
+    /* Append new entry first, old one may still be the source of the value */
+    off = lwobj->vars_len;
+    LWSHELL_MEMCPY(&lwobj->vars[off], name, name_len);
+    LWSHELL_MEMCPY(&lwobj->vars[off + name_len], value, value_len);
+    lwobj->vars_len += (uint16_t)(name_len + value_len);
+    if (slot < LWSHELL_CFG_VARS_HASH_SIZE) {
+        prv_var_remove(lwobj, lwobj->vars_index[slot] - 1U);
+    } else {
+        lwobj->vars_index[empty_slot] = (uint16_t)(off + 1U);
+    }
+    return lwshellOK;
+}
+
+/**
+ * \brief           Get shell variable value
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       name: Variable name
+ * \return          Pointer to null-terminated value on success, `NULL` if variable does not exist
+ * \note            Available only when \ref LWSHELL_CFG_USE_VARS is enabled
+ */
+const char*
+lwshell_get_var_ex(lwshell_t* lwobj, const char* name) {
+    size_t slot;
+
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    if (name == NULL || (slot = prv_var_find(lwobj, name, NULL)) >= LWSHELL_CFG_VARS_HASH_SIZE) {
+        return NULL;
+    }
+    return &lwobj->vars[lwobj->vars_index[slot] - 1U + strlen(name) + 1U];
+}
+
+#endif /* LWSHELL_CFG_USE_VARS || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_ALIAS || __DOXYGEN__
+
+/**
+ * \brief           Define, overwrite or delete command alias
+ *
+ * Definition is split to words on space and `;` characters. Every `;` starts new command,
+ * making the alias a macro of multiple commands. First word of every command must be
+ * a registered command, which is resolved when alias is defined.
+ * Commands of the alias are stored pre-tokenized and dispatched without the tokenizer.
+ *
+ * Arguments of executing alias point to the aliases arena, therefore aliases
+ * cannot be defined, overwritten or deleted from a command executed by an alias.
+ *
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       name: Alias name. It must not include space, `"`, `;` or `$` characters
+ *                      and must not be name of built-in or registered command
+ * \param[in]       def: Alias definition, eg. `"status -v all"` or `"reset; status"`.
+ *                      Set to `NULL` to delete alias
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise.
+ *                  \ref lwshellERR when called while an alias is executing
+ * \note            Available only when \ref LWSHELL_CFG_USE_ALIAS is enabled
+ */
+lwshellr_t
+lwshell_set_alias_ex(lwshell_t* lwobj, const char* name, const char* def) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    return prv_alias_define(lwobj, name, def != NULL ? 1U : 0U, &def);
+}
+
+#endif /* LWSHELL_CFG_USE_ALIAS || __DOXYGEN__ */
+
+#if LWSHELL_CFG_USE_ECHO_MODE || __DOXYGEN__
+
+/**
+ * \brief           Set echo mode of the instance.
+ *
+ * Mode can be changed at any time, also from command function,
+ * for example to mask password entered in the next line
+ *
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       mode: Echo mode, member of \ref lwshell_echo_mode_t
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_ECHO_MODE is enabled
+ */
+lwshellr_t
+lwshell_set_echo_mode_ex(lwshell_t* lwobj, lwshell_echo_mode_t mode) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    if (mode != LWSHELL_ECHO_MODE_INTERACTIVE && mode != LWSHELL_ECHO_MODE_MASKED && mode != LWSHELL_ECHO_MODE_NONE
+        && mode != LWSHELL_ECHO_MODE_RAW) {
         return lwshellERRPAR;
     }
+    lwobj->echo_mode = (uint8_t)mode;
+    return lwshellOK;
+}
+
+#endif /* LWSHELL_CFG_USE_ECHO_MODE || __DOXYGEN__ */
 
+/**
+ * \brief           Process input data with the input state machine
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       p_data: Input data to process
+ * \param[in]       len: Length of data for input
+ */
+static void
+prv_input(lwshell_t* lwobj, const char* p_data, size_t len) {
     /* Process all bytes */
     for (size_t idx = 0; idx < len; ++idx) {
-        switch (p_data[idx]) {
-            case LWSHELL_ASCII_CR: {
-                LWSHELL_OUTPUT(lwobj, "\r");
-                prv_parse_input(lwobj);
-                LWSHELL_RESET_BUFF(lwobj);
-                break;
+#if LWSHELL_CFG_USE_LINE_COALESCE
+        /* Second character of CRLF or LFCR pair belongs to already processed line end */
+        if (lwobj->line_end != 0) {
+            char line_end = lwobj->line_end;
+
+            lwobj->line_end = 0;
+            if ((p_data[idx] == LWSHELL_ASCII_CR || p_data[idx] == LWSHELL_ASCII_LF) && p_data[idx] != line_end) {
+                continue;
+            }
+        }
+#endif /* LWSHELL_CFG_USE_LINE_COALESCE */
+#if LWSHELL_CFG_USE_PAYLOAD
+        /* Forward payload until end of line, as single chunk per call */
+        if (lwobj->payload_fn != NULL && p_data[idx] != LWSHELL_ASCII_CR && p_data[idx] != LWSHELL_ASCII_LF) {
+            size_t end = idx;
+            while (end < len && p_data[end] != LWSHELL_ASCII_CR && p_data[end] != LWSHELL_ASCII_LF) {
+                ++end;
             }
+            lwobj->payload_fn(lwobj, &p_data[idx], end - idx);
+            idx = end - 1;
+            continue;
+        }
+#endif /* LWSHELL_CFG_USE_PAYLOAD */
+        switch (p_data[idx]) {
+            case LWSHELL_ASCII_CR:
             case LWSHELL_ASCII_LF: {
-                LWSHELL_OUTPUT(lwobj, "\n");
+#if LWSHELL_CFG_USE_LINE_COALESCE
+                lwobj->line_end = p_data[idx];
+                if (LWSHELL_ECHO_ON(lwobj)) {
+                    LWSHELL_OUTPUT(lwobj, LWSHELL_CFG_NEWLINE);
+                }
+#else
+                if (LWSHELL_ECHO_ON(lwobj)) {
+                    LWSHELL_OUTPUT(lwobj, p_data[idx] == LWSHELL_ASCII_CR ? "\r" : "\n");
+                }
+#endif /* LWSHELL_CFG_USE_LINE_COALESCE */
                 prv_parse_input(lwobj);
                 LWSHELL_RESET_BUFF(lwobj);
+                LWSHELL_RESET_PAYLOAD(lwobj);
+                LWSHELL_RESET_RESULT(lwobj);
                 break;
             }
             case LWSHELL_ASCII_BACKSPACE: {
-                /* Try to delete character from buffer */
-                if (lwobj->buff_ptr > 0) {
+                /* Try to delete character from buffer, raw mode ignores it */
+                if (lwobj->buff_ptr > 0 && LWSHELL_LINE_EDIT(lwobj)) {
                     --lwobj->buff_ptr;
                     lwobj->buff[lwobj->buff_ptr] = '\0';
-                    LWSHELL_OUTPUT(lwobj, "\b \b");
+                    if (LWSHELL_ECHO_ON(lwobj)) {
+                        LWSHELL_OUTPUT(lwobj, "\b \b");
+                    }
                 }
                 break;
             }
             default: {
-                char str[2] = {p_data[idx], 0};
-                LWSHELL_OUTPUT(lwobj, str);
+#if LWSHELL_CFG_USE_OUTPUT
+                if (LWSHELL_ECHO_ON(lwobj)) {
+                    char str[2] = {p_data[idx], 0};
+#if LWSHELL_CFG_USE_ECHO_MODE
+                    /* Masked mode hides printable characters and does not echo others */
+                    if (lwobj->echo_mode == LWSHELL_ECHO_MODE_MASKED) {
+                        str[0] = p_data[idx] >= 0x20 && p_data[idx] < 0x7F ? LWSHELL_CFG_ECHO_MASK_CHAR : '\0';
+                    }
+#endif /* LWSHELL_CFG_USE_ECHO_MODE */
+                    if (str[0] != '\0') { /* Nothing to echo, no empty output */
+                        LWSHELL_OUTPUT(lwobj, str);
+                    }
+                }
+#endif /* LWSHELL_CFG_USE_OUTPUT */
                 if (p_data[idx] >= 0x20 && p_data[idx] < 0x7F) {
                     LWSHELL_ADD_CH(lwobj, p_data[idx]);
+#if LWSHELL_CFG_USE_PAYLOAD
+                    /* Buffer may be empty when allocation failed */
+                    if (p_data[idx] == LWSHELL_ASCII_SPACE && !lwobj->payload_checked && lwobj->buff_ptr > 0) {
+                        prv_payload_check(lwobj);
+                    }
+#endif /* LWSHELL_CFG_USE_PAYLOAD */
+                }
+            }
+        }
+    }
+}
+
+#if LWSHELL_CFG_USE_RATE_LIMIT || __DOXYGEN__
+
+/* Number of token units per byte or command, tokens are kept with millisecond resolution */
+#define LWSHELL_RATE_TOKEN 1000U
+
+/**
+ * \brief           Refill token buckets with time elapsed since last refill.
+ *
+ * Every bucket holds up to one second worth of tokens
+ *
+ * \param[in]       lwobj: LwSHELL instance
+ */
+static void
+prv_rate_refill(lwshell_t* lwobj) {
+    uint32_t now, elapsed;
+
+    if (lwobj->time_fn == NULL) {
+        return;
+    }
+    now = lwobj->time_fn(lwobj);
+    elapsed = now - lwobj->rate_time;
+    lwobj->rate_time = now;
+    for (size_t idx = 0; idx < LWSHELL_ARRAYSIZE(lwobj->rate); ++idx) {
+        unsigned long long tokens =
+            (unsigned long long)lwobj->rate_tokens[idx] + (unsigned long long)elapsed * lwobj->rate[idx];
+        unsigned long long max = (unsigned long long)lwobj->rate[idx] * LWSHELL_RATE_TOKEN;
+
+        lwobj->rate_tokens[idx] = (uint32_t)(tokens < max ? tokens : max);
+    }
+}
+
+/**
+ * \brief           Process queued input data, as much as token buckets allow
+ * \param[in]       lwobj: LwSHELL instance
+ */
+static void
+prv_rate_process(lwshell_t* lwobj) {
+    prv_rate_refill(lwobj);
+    while (lwobj->rate_queue_len > 0) {
+        const char* data = &lwobj->rate_queue[lwobj->rate_queue_head];
+        size_t len = sizeof(lwobj->rate_queue) - lwobj->rate_queue_head, cnt, line_len = lwobj->buff_ptr;
+
+        /* Contiguous part of the queue, limited by bytes bucket */
+        len = len < lwobj->rate_queue_len ? len : lwobj->rate_queue_len;
+        if (lwobj->rate[0] > 0 && lwobj->rate_tokens[0] / LWSHELL_RATE_TOKEN < len) {
+            len = lwobj->rate_tokens[0] / LWSHELL_RATE_TOKEN;
+        }
+
+        /* Line terminator of non-empty line executes command and takes command token */
+        for (cnt = 0; cnt < len && lwobj->rate[1] > 0; ++cnt) {
+            if (data[cnt] == LWSHELL_ASCII_CR || data[cnt] == LWSHELL_ASCII_LF) {
+                if (line_len > 0) {
+                    if (lwobj->rate_tokens[1] < LWSHELL_RATE_TOKEN) {
+                        break;
+                    }
+                    lwobj->rate_tokens[1] -= LWSHELL_RATE_TOKEN;
                 }
+                line_len = 0;
+            } else if (data[cnt] == LWSHELL_ASCII_BACKSPACE && LWSHELL_LINE_EDIT(lwobj)) {
+                line_len -= line_len > 0 ? 1 : 0;
+            } else if (data[cnt] >= 0x20 && data[cnt] < 0x7F) {
+                ++line_len;
+            }
+        }
+        if (lwobj->rate[1] == 0) {
+            cnt = len;
+        }
+        if (cnt == 0) {
+            break;
+        }
+        if (lwobj->rate[0] > 0) {
+            lwobj->rate_tokens[0] -= (uint32_t)cnt * LWSHELL_RATE_TOKEN;
+        }
+        lwobj->rate_queue_head = (uint16_t)((lwobj->rate_queue_head + cnt) % sizeof(lwobj->rate_queue));
+        lwobj->rate_queue_len -= (uint16_t)cnt;
+        prv_input(lwobj, data, cnt);
+    }
+}
+
+/**
+ * \brief           Set input rate limits of the instance.
+ *
+ * Input that exceeds the limits is queued in the instance queue of \ref LWSHELL_CFG_RATE_QUEUE_SIZE bytes,
+ * and processed later by \ref lwshell_input_ex or \ref lwshell_process_ex functions.
+ * Data that does not fit to the queue is dropped.
+ *
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       bytes_per_s: Maximum number of processed input bytes per second. `0` for no limit
+ * \param[in]       cmds_per_s: Maximum number of executed commands per second. `0` for no limit
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Time function must be set with \ref lwshell_set_time_fn_ex
+ * \note            Available only when \ref LWSHELL_CFG_USE_RATE_LIMIT is enabled
+ */
+lwshellr_t
+lwshell_set_rate_limit_ex(lwshell_t* lwobj, uint32_t bytes_per_s, uint32_t cmds_per_s) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    if (bytes_per_s > UINT32_MAX / LWSHELL_RATE_TOKEN || cmds_per_s > UINT32_MAX / LWSHELL_RATE_TOKEN) {
+        return lwshellERRPAR;
+    }
+    lwobj->rate[0] = bytes_per_s;
+    lwobj->rate[1] = cmds_per_s;
+    lwobj->rate_tokens[0] = bytes_per_s * LWSHELL_RATE_TOKEN;
+    lwobj->rate_tokens[1] = cmds_per_s * LWSHELL_RATE_TOKEN;
+    lwobj->rate_time = lwobj->time_fn != NULL ? lwobj->time_fn(lwobj) : 0;
+    prv_rate_process(lwobj); /* Queue is flushed without limits, if they are disabled */
+    return lwshellOK;
+}
+
+/**
+ * \brief           Process input data queued due to rate limits.
+ *
+ * Call it periodically from the main loop, when rate limits are used.
+ *
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise
+ * \note            Available only when \ref LWSHELL_CFG_USE_RATE_LIMIT is enabled
+ */
+lwshellr_t
+lwshell_process_ex(lwshell_t* lwobj) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    prv_rate_process(lwobj);
+    return lwshellOK;
+}
+
+/**
+ * \brief           Get number of input bytes dropped due to full rate limiting queue
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \return          Number of dropped bytes since initialization
+ * \note            Available only when \ref LWSHELL_CFG_USE_RATE_LIMIT is enabled
+ */
+size_t
+lwshell_get_dropped_ex(lwshell_t* lwobj) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+    return lwobj->rate_dropped;
+}
+
+#endif /* LWSHELL_CFG_USE_RATE_LIMIT || __DOXYGEN__ */
+
+/**
+ * \brief           Input data to shell processing
+ * \param[in]       lwobj: LwSHELL object instance. Set to `NULL` to use default one
+ * \param[in]       in_data: Input data to process
+ * \param[in]       len: Length of data for input
+ * \return          \ref lwshellOK on success, member of \ref lwshellr_t otherwise.
+ *                  \ref lwshellERRMEM when data has been dropped due to rate limits
+ */
+lwshellr_t
+lwshell_input_ex(lwshell_t* lwobj, const void* in_data, size_t len) {
+    lwobj = LWSHELL_GET_LWOBJ(lwobj);
+
+    if (in_data == NULL || len == 0) {
+        return lwshellERRPAR;
+    }
+    LWSHELL_TRANSCRIPT(lwobj, LWSHELL_TRANSCRIPT_REC_INPUT, in_data, len);
+
+#if LWSHELL_CFG_USE_RATE_LIMIT
+    if (lwobj->rate[0] > 0 || lwobj->rate[1] > 0) {
+        const char* p_data = in_data;
+        lwshellr_t res = lwshellOK;
+
+        /* Queue data first to keep the order, then process what is allowed */
+        for (size_t idx = 0; idx < len; ++idx) {
+            if (lwobj->rate_queue_len < sizeof(lwobj->rate_queue)) {
+                lwobj->rate_queue[(lwobj->rate_queue_head + lwobj->rate_queue_len) % sizeof(lwobj->rate_queue)] =
+                    p_data[idx];
+                ++lwobj->rate_queue_len;
+            } else {
+                ++lwobj->rate_dropped;
+                res = lwshellERRMEM;
             }
         }
+        prv_rate_process(lwobj);
+        return res;
     }
+#endif /* LWSHELL_CFG_USE_RATE_LIMIT */
+    prv_input(lwobj, in_data, len);
     return lwshellOK;
 }
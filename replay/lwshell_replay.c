@@ -0,0 +1,331 @@
+/**
+ * \file            lwshell_replay.c
+ * \brief           LwSHELL transcript replay tool
+ *
+ * Tool feeds input records of transcript, recorded with \ref LWSHELL_CFG_USE_TRANSCRIPT,
+ * to the shell instance, either at full speed or with original pacing.
+ * It measures input throughput and compares produced output with the recorded one.
+ *
+ * Usage: lwshell_replay [-p] [-c name]... file
+ *
+ *  - `-p`: Keep original pacing between records
+ *  - `-c name`: Register stub command `name`, that prints nothing.
+ *      Used for transcripts without command records, as commands recorded
+ *      in the transcript are registered as stubs with their original description.
+ *      Output of real commands cannot be reproduced on host,
+ *      differences caused by it are expected
+ *
+ * Result is printed as single JSON object line
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lwshell/lwshell.h"
+
+/**
+ * \brief           Growable byte buffer
+ */
+typedef struct {
+    uint8_t* data; /*!< Buffer data */
+    size_t len;    /*!< Number of used bytes */
+    size_t size;   /*!< Allocated size in bytes */
+} replay_buff_t;
+
+/* Output produced during replay */
+static replay_buff_t out_produced;
+
+/* Static commands recorded in the transcript, registered as stubs */
+static lwshell_cmd_t* static_stubs;
+static size_t static_stubs_cnt;
+
+/* Stub commands given on command line, `NULL` when recorded in the transcript */
+static const char* stubs[LWSHELL_CFG_MAX_DYNAMIC_CMDS];
+static size_t stubs_cnt;
+static int stubs_registered;
+
+/**
+ * \brief           Get current time in units of seconds
+ * \return          Monotonic-like time in seconds
+ */
+static double
+prv_now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief           Append data to buffer, exit on memory error
+ * \param[in]       buff: Buffer to append to
+ * \param[in]       data: Data to append
+ * \param[in]       len: Length of data in bytes
+ */
+static void
+prv_buff_append(replay_buff_t* buff, const void* data, size_t len) {
+    if (buff->len + len > buff->size) {
+        size_t size = buff->size > 0 ? buff->size : 256;
+        uint8_t* ptr;
+
+        while (size < buff->len + len) {
+            size *= 2;
+        }
+        if ((ptr = realloc(buff->data, size)) == NULL) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+        buff->data = ptr;
+        buff->size = size;
+    }
+    if (len > 0) {
+        memcpy(&buff->data[buff->len], data, len);
+        buff->len += len;
+    }
+}
+
+/**
+ * \brief           Output function, collecting produced output
+ * \param[in]       str: String to print, null-terminated
+ * \param[in]       lw: LwSHELL instance
+ */
+static void
+prv_output(const char* str, lwshell_t* lw) {
+    (void)lw;
+    prv_buff_append(&out_produced, str, strlen(str));
+}
+
+/**
+ * \brief           Stub command, doing nothing
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ * \return          `0` on success
+ */
+static int32_t
+prv_stub_cmd(int32_t argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    return 0;
+}
+
+/**
+ * \brief           Register stub command, exit on error
+ * \param[in]       name: Command name
+ * \param[in]       desc: Command description
+ */
+static void
+prv_stub_register(const char* name, const char* desc) {
+    if (lwshell_register_cmd(name, prv_stub_cmd, desc) != lwshellOK) {
+        fprintf(stderr, "Cannot register command %s\n", name);
+        exit(1);
+    }
+}
+
+/**
+ * \brief           Register static stub command, exit on memory error
+ * \param[in]       name: Command name
+ * \param[in]       desc: Command description
+ */
+static void
+prv_stub_register_static(const char* name, const char* desc) {
+    lwshell_cmd_t* cmds = realloc(static_stubs, (static_stubs_cnt + 1) * sizeof(*cmds));
+
+    if (cmds == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    memset(&cmds[static_stubs_cnt], 0x00, sizeof(*cmds));
+    cmds[static_stubs_cnt].fn = prv_stub_cmd;
+    cmds[static_stubs_cnt].name = name;
+    cmds[static_stubs_cnt].desc = desc;
+    static_stubs = cmds;
+    lwshell_register_static_cmds(static_stubs, ++static_stubs_cnt);
+}
+
+/**
+ * \brief           Register stub command recorded in the transcript.
+ *
+ * Command line stub with the same name is replaced, unless it is already registered
+ *
+ * \param[in]       name: Command name
+ * \param[in]       desc: Command description
+ * \param[in]       flags: Record flags, `LWSHELL_TRANSCRIPT_CMD_FLAG_*` values
+ */
+static void
+prv_stub_recorded(const char* name, const char* desc, uint8_t flags) {
+    for (size_t idx = 0; idx < stubs_cnt; ++idx) {
+        if (stubs[idx] != NULL && strcmp(stubs[idx], name) == 0) {
+            if (stubs_registered) {
+                return;
+            }
+            stubs[idx] = NULL;
+        }
+    }
+    if (flags & LWSHELL_TRANSCRIPT_CMD_FLAG_STATIC) {
+        prv_stub_register_static(name, desc);
+    } else {
+        prv_stub_register(name, desc);
+    }
+}
+
+/**
+ * \brief           Register command line stubs not recorded in the transcript, before first input
+ */
+static void
+prv_stub_register_rest(void) {
+    if (!stubs_registered) {
+        for (size_t idx = 0; idx < stubs_cnt; ++idx) {
+            if (stubs[idx] != NULL) {
+                prv_stub_register(stubs[idx], "Replay stub command");
+            }
+        }
+        stubs_registered = 1;
+    }
+}
+
+/**
+ * \brief           Decode variable length integer
+ * \param[in]       data: Transcript data
+ * \param[in]       len: Length of transcript data
+ * \param[in,out]   pos: Current position, updated after decoding
+ * \param[out]      val: Decoded value
+ * \return          `0` on success, `-1` on malformed data
+ */
+static int
+prv_varint(const uint8_t* data, size_t len, size_t* pos, unsigned long long* val) {
+    *val = 0;
+    for (unsigned shift = 0; *pos < len && shift < 64; shift += 7) {
+        uint8_t byte = data[(*pos)++];
+
+        *val |= (unsigned long long)(byte & 0x7FU) << shift;
+        if ((byte & 0x80U) == 0) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * \brief           Read complete file to buffer
+ * \param[in]       path: File path
+ * \param[out]      buff: Buffer to read to
+ * \return          `0` on success, `-1` otherwise
+ */
+static int
+prv_read_file(const char* path, replay_buff_t* buff) {
+    FILE* f = fopen(path, "rb");
+    uint8_t chunk[4096];
+    size_t len;
+
+    if (f == NULL) {
+        return -1;
+    }
+    while ((len = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        prv_buff_append(buff, chunk, len);
+    }
+    fclose(f);
+    return 0;
+}
+
+/* Program entry point */
+int
+main(int argc, char** argv) {
+    static const uint8_t magic[] = LWSHELL_TRANSCRIPT_MAGIC;
+    replay_buff_t file = {0}, out_expected = {0};
+    const char* path = NULL;
+    double elapsed = 0, start;
+    size_t pos, records = 0, in_bytes = 0, mismatch;
+    unsigned long long time_ms = 0;
+    int pacing = 0;
+
+    lwshell_init();
+    lwshell_set_output_fn(prv_output);
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-p") == 0) {
+            pacing = 1;
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            if (stubs_cnt == LWSHELL_ARRAYSIZE(stubs)) {
+                fprintf(stderr, "Cannot register command %s\n", argv[i + 1]);
+                return 1;
+            }
+            stubs[stubs_cnt++] = argv[++i];
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == NULL) {
+        fprintf(stderr, "Usage: %s [-p] [-c name]... file\n", argv[0]);
+        return 1;
+    }
+    if (prv_read_file(path, &file) != 0) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+    if (file.len < sizeof(magic) || memcmp(file.data, magic, sizeof(magic)) != 0) {
+        fprintf(stderr, "Not a transcript file or unsupported version\n");
+        return 1;
+    }
+
+    /* Process all records */
+    start = prv_now();
+    for (pos = sizeof(magic); pos < file.len; ++records) {
+        unsigned long long delta, len;
+        uint8_t type = file.data[pos++];
+
+        if (prv_varint(file.data, file.len, &pos, &delta) != 0 || prv_varint(file.data, file.len, &pos, &len) != 0
+            || len > file.len - pos) {
+            fprintf(stderr, "Malformed record %u at offset %u\n", (unsigned)records, (unsigned)pos);
+            return 1;
+        }
+        time_ms += delta;
+        if (type == LWSHELL_TRANSCRIPT_REC_CMD) {
+            const uint8_t* desc = len > 1 ? memchr(&file.data[pos + 1], '\0', (size_t)len - 1) : NULL;
+
+            /* Name and description are null-terminated, file buffer stays valid until the end */
+            if (desc == NULL || desc == &file.data[pos + len - 1] || file.data[pos + len - 1] != '\0') {
+                fprintf(stderr, "Malformed record %u at offset %u\n", (unsigned)records, (unsigned)pos);
+                return 1;
+            }
+            prv_stub_recorded((const char*)&file.data[pos + 1], (const char*)desc + 1, file.data[pos]);
+        } else if (type == LWSHELL_TRANSCRIPT_REC_INPUT) {
+            double t;
+
+            prv_stub_register_rest();
+
+            /* Busy-wait for original record time, for accurate pacing */
+            while (pacing && (prv_now() - start) * 1000.0 < (double)time_ms) {}
+            t = prv_now();
+            lwshell_input(&file.data[pos], (size_t)len);
+            elapsed += prv_now() - t;
+            in_bytes += (size_t)len;
+        } else if (type == LWSHELL_TRANSCRIPT_REC_OUTPUT) {
+            prv_buff_append(&out_expected, &file.data[pos], (size_t)len);
+        }
+        pos += (size_t)len;
+    }
+
+    /* Find first output difference */
+    for (mismatch = 0; mismatch < out_produced.len && mismatch < out_expected.len
+                       && out_produced.data[mismatch] == out_expected.data[mismatch];
+         ++mismatch) {}
+    if (mismatch == out_produced.len && mismatch == out_expected.len) {
+        mismatch = SIZE_MAX;
+    } else {
+        fprintf(stderr, "Output differs at offset %u\nexpected: \"%.*s\"\nproduced: \"%.*s\"\n", (unsigned)mismatch,
+                (int)(out_expected.len - mismatch < 32 ? out_expected.len - mismatch : 32),
+                (const char*)&out_expected.data[mismatch],
+                (int)(out_produced.len - mismatch < 32 ? out_produced.len - mismatch : 32),
+                (const char*)&out_produced.data[mismatch]);
+    }
+
+    printf("{\"records\":%u,\"input_bytes\":%u,\"recorded_ms\":%llu,\"seconds\":%.6f,\"bytes_per_s\":%.0f,"
+           "\"output_bytes\":%u,\"expected_bytes\":%u,\"output_match\":%s,\"mismatch_offset\":%ld}\n",
+           (unsigned)records, (unsigned)in_bytes, time_ms, elapsed, elapsed > 0 ? (double)in_bytes / elapsed : 0.0,
+           (unsigned)out_produced.len, (unsigned)out_expected.len, mismatch == SIZE_MAX ? "true" : "false",
+           mismatch == SIZE_MAX ? -1L : (long)mismatch);
+    free(file.data);
+    free(out_expected.data);
+    free(out_produced.data);
+    free(static_stubs);
+    return mismatch == SIZE_MAX ? 0 : 2;
+}
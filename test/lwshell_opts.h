@@ -0,0 +1,69 @@
+/**
+ * \file            lwshell_opts.h
+ * \brief           LwSHELL unit tests options
+ */
+
+/*
+ * Copyright (c) 2024 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight shell library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         v1.2.0
+ */
+#ifndef LWSHELL_HDR_OPTS_H
+#define LWSHELL_HDR_OPTS_H
+
+
+/*
+ * Unit tests configuration.
+ *
+ * Features under test are enabled, tests of disabled features are skipped
+ */
+#define LWSHELL_CFG_USE_OUTPUT            1
+#define LWSHELL_CFG_USE_LIST_CMD          1
+#define LWSHELL_CFG_USE_DYNAMIC_COMMANDS  1
+#define LWSHELL_CFG_USE_STATIC_COMMANDS   1
+#define LWSHELL_CFG_USE_VARS              1
+#define LWSHELL_CFG_VARS_ARENA_SIZE       128
+#define LWSHELL_CFG_USE_ALIAS             1
+#define LWSHELL_CFG_USE_PRINTF            1
+#define LWSHELL_CFG_USE_STRUCTURED_OUTPUT 1
+#define LWSHELL_CFG_USE_PERMISSIONS       1
+#define LWSHELL_CFG_USE_ECHO_MODE         1
+#define LWSHELL_CFG_USE_RESULT            1
+#define LWSHELL_CFG_USE_RATE_LIMIT        1
+#define LWSHELL_CFG_USE_TRANSCRIPT        1
+#define LWSHELL_CFG_USE_PAYLOAD           1
+#define LWSHELL_CFG_RATE_QUEUE_SIZE       16
+
+/*
+ * Allocator failing on purpose, to test out-of-memory paths with LWSHELL_CFG_USE_ALLOC
+ */
+#if LWSHELL_TEST_ALLOC
+#include <stddef.h>
+void* test_realloc(void* ptr, size_t size);
+#define LWSHELL_REALLOC(ptr, size) test_realloc((ptr), (size))
+#endif /* LWSHELL_TEST_ALLOC */
+
+#endif /* LWSHELL_HDR_OPTS_H */
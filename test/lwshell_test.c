@@ -0,0 +1,1171 @@
+/**
+ * \file            lwshell_test.c
+ * \brief           LwSHELL unit tests
+ *
+ * Regression tests of library API, run by `ctest`.
+ * Every test function returns number of failed checks
+ */
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lwshell/lwshell.h"
+#if LWSHELL_CFG_USE_PRINTF && LWSHELL_CFG_PRINTF_FLOAT
+#include <float.h>
+#include <math.h>
+#endif /* LWSHELL_CFG_USE_PRINTF && LWSHELL_CFG_PRINTF_FLOAT */
+
+/* Check condition, print location and count failure when it is false */
+#define TEST_CHECK(cond)                                                                                               \
+    do {                                                                                                               \
+        if (!(cond)) {                                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                                   \
+            ++failed;                                                                                                  \
+        }                                                                                                              \
+    } while (0)
+
+/* Number of calls of counting command */
+static int count_calls;
+
+/**
+ * \brief           Initialize default instance for the next test
+ */
+static void
+prv_shell_init(void) {
+#if LWSHELL_CFG_USE_ALLOC
+    lwshell_deinit(); /* Memory of the previous test */
+#endif /* LWSHELL_CFG_USE_ALLOC */
+    lwshell_init();
+}
+
+/**
+ * \brief           Command counting its calls
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ * \return          `0` on success
+ */
+static int32_t
+prv_count_cmd(int32_t argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    ++count_calls;
+    return 0;
+}
+
+#if LWSHELL_CFG_USE_OUTPUT
+
+/* Output collected from the shell and number of empty outputs */
+static char out_buff[512];
+static int out_empty;
+
+/**
+ * \brief           Append shell output to the test buffer
+ * \param[in]       str: String to print
+ * \param[in]       lwobj: LwSHELL instance
+ */
+static void
+prv_out_collect(const char* str, lwshell_t* lwobj) {
+    (void)lwobj;
+    if (str[0] == '\0') {
+        ++out_empty;
+    }
+    strncat(out_buff, str, sizeof(out_buff) - strlen(out_buff) - 1);
+}
+
+/* Echo of received line feed */
+#if LWSHELL_CFG_USE_LINE_COALESCE
+#define TEST_ECHO_LF LWSHELL_CFG_NEWLINE
+#else
+#define TEST_ECHO_LF "\n"
+#endif /* LWSHELL_CFG_USE_LINE_COALESCE */
+
+/* Input line, split to calls with `|` character, expected echo and number of executed commands */
+typedef struct {
+    const char* input;
+    const char* echo;
+    int calls;
+} test_line_end_t;
+
+/**
+ * \brief           Line delimiters end the line and are echoed according to configuration
+ * \return          Number of failed checks
+ */
+static int
+prv_test_line_ends(void) {
+    static const test_line_end_t cases[] = {
+#if LWSHELL_CFG_USE_LINE_COALESCE
+        {"ab\r\n", "ab" LWSHELL_CFG_NEWLINE, 1},
+        {"ab\n\r", "ab" LWSHELL_CFG_NEWLINE, 1},
+        {"ab\rab\r", "ab" LWSHELL_CFG_NEWLINE "ab" LWSHELL_CFG_NEWLINE, 2},
+        {"ab\r|\nab\n", "ab" LWSHELL_CFG_NEWLINE "ab" LWSHELL_CFG_NEWLINE, 2},
+        {"ab\r|\rab\r", "ab" LWSHELL_CFG_NEWLINE LWSHELL_CFG_NEWLINE "ab" LWSHELL_CFG_NEWLINE, 2},
+        {"ab\n\n\r\r", "ab" LWSHELL_CFG_NEWLINE LWSHELL_CFG_NEWLINE LWSHELL_CFG_NEWLINE, 1},
+#else
+        {"ab\r\n", "ab\r\n", 1},
+        {"ab\n\r", "ab\n\r", 1},
+        {"ab\rab\r", "ab\rab\r", 2},
+        {"ab\r|\nab\n", "ab\r\nab\n", 2},
+        {"ab\r|\rab\r", "ab\r\rab\r", 2},
+#endif /* LWSHELL_CFG_USE_LINE_COALESCE */
+    };
+    int failed = 0;
+
+    prv_shell_init();
+    lwshell_set_output_fn(prv_out_collect);
+    TEST_CHECK(lwshell_register_cmd("ab", prv_count_cmd, NULL) == lwshellOK);
+    for (size_t idx = 0; idx < LWSHELL_ARRAYSIZE(cases); ++idx) {
+        const char *str = cases[idx].input, *end;
+
+        out_buff[0] = '\0';
+        count_calls = 0;
+        for (; *str != '\0'; str = *end != '\0' ? end + 1 : end) {
+            end = strchr(str, '|') != NULL ? strchr(str, '|') : &str[strlen(str)];
+            lwshell_input(str, (size_t)(end - str));
+        }
+        TEST_CHECK(strcmp(out_buff, cases[idx].echo) == 0);
+        TEST_CHECK(count_calls == cases[idx].calls);
+    }
+    lwshell_set_output_fn(NULL);
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_OUTPUT */
+
+#if LWSHELL_CFG_USE_ECHO_MODE && LWSHELL_CFG_USE_OUTPUT
+
+/**
+ * \brief           Echo modes output and line editing
+ * \return          Number of failed checks
+ */
+static int
+prv_test_echo_modes(void) {
+    static const char line[] = "ab\x01" "c\b\n";
+    static const char line_zero[] = "ab\0\n";
+    int failed = 0;
+
+    prv_shell_init();
+    lwshell_set_output_fn(prv_out_collect);
+    count_calls = 0;
+    out_empty = 0;
+    TEST_CHECK(lwshell_register_cmd("ab", prv_count_cmd, NULL) == lwshellOK);
+    TEST_CHECK(lwshell_set_echo_mode((lwshell_echo_mode_t)0x10) == lwshellERRPAR);
+
+    /* Interactive mode echoes every character, except null */
+    out_buff[0] = '\0';
+    lwshell_input(line_zero, sizeof(line_zero) - 1);
+    TEST_CHECK(strcmp(out_buff, "ab" TEST_ECHO_LF) == 0);
+    TEST_CHECK(count_calls == 1);
+
+    /* Masked mode hides printable characters, others are not echoed at all */
+    TEST_CHECK(lwshell_set_echo_mode(LWSHELL_ECHO_MODE_MASKED) == lwshellOK);
+    out_buff[0] = '\0';
+    lwshell_input(line, sizeof(line) - 1);
+    TEST_CHECK(strcmp(out_buff, "***\b \b" TEST_ECHO_LF) == 0);
+    TEST_CHECK(count_calls == 2);
+
+    /* No echo, backspace still edits the line */
+    TEST_CHECK(lwshell_set_echo_mode(LWSHELL_ECHO_MODE_NONE) == lwshellOK);
+    out_buff[0] = '\0';
+    lwshell_input(line, sizeof(line) - 1);
+    TEST_CHECK(out_buff[0] == '\0');
+    TEST_CHECK(count_calls == 3);
+
+    /* Raw mode ignores backspace, line is `abc` */
+    TEST_CHECK(lwshell_set_echo_mode(LWSHELL_ECHO_MODE_RAW) == lwshellOK);
+    out_buff[0] = '\0';
+    lwshell_input(line, sizeof(line) - 1);
+    TEST_CHECK(strncmp(out_buff, "Unknown command", 15) == 0);
+    TEST_CHECK(count_calls == 3);
+
+    TEST_CHECK(out_empty == 0);
+    lwshell_set_output_fn(NULL);
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_ECHO_MODE && LWSHELL_CFG_USE_OUTPUT */
+
+#if LWSHELL_CFG_USE_STRUCTURED_OUTPUT && LWSHELL_CFG_USE_OUTPUT
+
+/**
+ * \brief           Structured output records in JSON lines and human-readable modes
+ * \return          Number of failed checks
+ */
+static int
+prv_test_structured(void) {
+    int failed = 0;
+
+    prv_shell_init();
+    lwshell_set_output_fn(prv_out_collect);
+    TEST_CHECK(lwshell_set_output_mode((lwshell_output_mode_t)0x10) == lwshellERRPAR);
+    TEST_CHECK(lwshell_emit_str(NULL, "v") == lwshellERRPAR);
+    TEST_CHECK(lwshell_emit_str("k", NULL) == lwshellERRPAR);
+    TEST_CHECK(lwshell_emit_int(NULL, 0) == lwshellERRPAR);
+    TEST_CHECK(lwshell_emit_bool(NULL, 0) == lwshellERRPAR);
+
+    /* Quote, backslash and control characters are escaped, other bytes are passed as they are */
+    TEST_CHECK(lwshell_set_output_mode(LWSHELL_OUTPUT_MODE_JSON) == lwshellOK);
+    out_buff[0] = '\0';
+    TEST_CHECK(lwshell_emit_begin() == lwshellOK);
+    TEST_CHECK(lwshell_emit_str("s", "q\"b\\s\t\x01" "x\x1f\x7f\xc3\xa9") == lwshellOK);
+    TEST_CHECK(lwshell_emit_str("k\"\n", "") == lwshellOK);
+    TEST_CHECK(lwshell_emit_int("min", LLONG_MIN) == lwshellOK);
+    TEST_CHECK(lwshell_emit_int("max", LLONG_MAX) == lwshellOK);
+    TEST_CHECK(lwshell_emit_int("zero", 0) == lwshellOK);
+    TEST_CHECK(lwshell_emit_bool("ok", 1) == lwshellOK);
+    TEST_CHECK(lwshell_emit_bool("no", 0) == lwshellOK);
+    TEST_CHECK(lwshell_emit_end() == lwshellOK);
+    TEST_CHECK(strcmp(out_buff, "{\"s\":\"q\\\"b\\\\s\\u0009\\u0001x\\u001f\x7f\xc3\xa9\","
+                                "\"k\\\"\\u000a\":\"\","
+                                "\"min\":-9223372036854775808,\"max\":9223372036854775807,\"zero\":0,"
+                                "\"ok\":true,\"no\":false}" LWSHELL_CFG_NEWLINE)
+               == 0);
+
+    /* Empty record and new record without leading separator */
+    out_buff[0] = '\0';
+    lwshell_emit_begin();
+    lwshell_emit_end();
+    lwshell_emit_begin();
+    lwshell_emit_int("n", -1);
+    lwshell_emit_end();
+    TEST_CHECK(strcmp(out_buff, "{}" LWSHELL_CFG_NEWLINE "{\"n\":-1}" LWSHELL_CFG_NEWLINE) == 0);
+
+    /* Human-readable mode prints values without escaping */
+    TEST_CHECK(lwshell_set_output_mode(LWSHELL_OUTPUT_MODE_HUMAN) == lwshellOK);
+    out_buff[0] = '\0';
+    lwshell_emit_begin();
+    lwshell_emit_str("s", "a \"b\"");
+    lwshell_emit_int("n", LLONG_MIN);
+    lwshell_emit_bool("ok", 0);
+    lwshell_emit_end();
+    TEST_CHECK(strcmp(out_buff, "s: a \"b\", n: -9223372036854775808, ok: false" LWSHELL_CFG_NEWLINE) == 0);
+    lwshell_set_output_fn(NULL);
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_STRUCTURED_OUTPUT && LWSHELL_CFG_USE_OUTPUT */
+
+#if LWSHELL_CFG_USE_RESULT
+
+/* Number of result notifications and the last notified result */
+static int result_calls;
+static lwshell_result_t result_last;
+
+/**
+ * \brief           Result function storing notified result
+ * \param[in]       result: Result of processed line
+ * \param[in]       lwobj: LwSHELL instance
+ */
+static void
+prv_result_collect(const lwshell_result_t* result, lwshell_t* lwobj) {
+    (void)lwobj;
+    ++result_calls;
+    result_last = *result;
+}
+
+/**
+ * \brief           Command returning negative number of arguments
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ * \return          Negative `argc`
+ */
+static int32_t
+prv_ret_cmd(int32_t argc, char** argv) {
+    (void)argv;
+    return -argc;
+}
+
+/* Input line with expected result */
+typedef struct {
+    const char* input;
+    lwshell_status_t status;
+    int32_t ret;
+    uint8_t flags;
+} test_result_t;
+
+/**
+ * \brief           Result of processed line reports status, return value and parse errors
+ * \return          Number of failed checks
+ */
+static int
+prv_test_result(void) {
+    static const test_result_t cases[] = {
+        {"ret\n", lwshellSTATUS_OK, -1, 0},
+        {"ret \"a b\n", lwshellSTATUS_OK, -2, LWSHELL_RESULT_FLAG_UNTERMINATED_QUOTE},
+        {"ret 1 2 3 4 5 6 7 8 9\n", lwshellSTATUS_OK, -LWSHELL_CFG_MAX_CMD_ARGS, LWSHELL_RESULT_FLAG_TOO_MANY_ARGS},
+        {"ret -h\n", lwshellSTATUS_HELP, 0, 0},
+        {"set v 1\n", lwshellSTATUS_BUILTIN, 0, 0},
+        {"nope\n", lwshellSTATUS_UNKNOWN_CMD, 0, 0},
+    };
+    char line[LWSHELL_CFG_MAX_INPUT_LEN + 8];
+    int failed = 0;
+
+    prv_shell_init();
+    result_calls = 0;
+    TEST_CHECK(lwshell_register_cmd("ret", prv_ret_cmd, "Return value") == lwshellOK);
+    TEST_CHECK(lwshell_set_result_fn(prv_result_collect) == lwshellOK);
+    for (size_t idx = 0; idx < LWSHELL_ARRAYSIZE(cases); ++idx) {
+        lwshell_input(cases[idx].input, strlen(cases[idx].input));
+        TEST_CHECK(result_calls == (int)idx + 1);
+        TEST_CHECK(result_last.status == (uint8_t)cases[idx].status);
+        TEST_CHECK(result_last.ret == cases[idx].ret);
+        TEST_CHECK(result_last.flags == cases[idx].flags);
+        TEST_CHECK(lwshell_get_result()->status == result_last.status && lwshell_get_result()->ret == result_last.ret
+                   && lwshell_get_result()->flags == result_last.flags);
+    }
+
+    /* Line over the input buffer is truncated, empty line is not reported */
+    memset(line, 'x', sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\n';
+    lwshell_input(line, sizeof(line));
+    TEST_CHECK(result_calls == (int)LWSHELL_ARRAYSIZE(cases) + 1);
+    TEST_CHECK(result_last.status == lwshellSTATUS_UNKNOWN_CMD);
+    TEST_CHECK(result_last.flags == LWSHELL_RESULT_FLAG_TRUNCATED);
+    lwshell_input("\n", 1);
+    TEST_CHECK(result_calls == (int)LWSHELL_ARRAYSIZE(cases) + 1);
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_RESULT */
+
+#if LWSHELL_CFG_USE_RATE_LIMIT || LWSHELL_CFG_USE_TRANSCRIPT
+
+/* Time returned to the shell, in milliseconds */
+static uint32_t test_time;
+
+/**
+ * \brief           Test time function
+ * \param[in]       lwobj: LwSHELL instance
+ * \return          Time in milliseconds
+ */
+static uint32_t
+prv_test_time(lwshell_t* lwobj) {
+    (void)lwobj;
+    return test_time;
+}
+
+#endif /* LWSHELL_CFG_USE_RATE_LIMIT || LWSHELL_CFG_USE_TRANSCRIPT */
+
+#if LWSHELL_CFG_USE_RATE_LIMIT
+
+/**
+ * \brief           Commands and bytes rate limits, burst size and refill timing
+ * \return          Number of failed checks
+ */
+static int
+prv_test_rate_limit(void) {
+    static const char lines[] = "ab\nab\nab\nab\n";
+    int failed = 0;
+
+    prv_shell_init();
+    count_calls = 0;
+    test_time = 1000;
+    TEST_CHECK(lwshell_register_cmd("ab", prv_count_cmd, NULL) == lwshellOK);
+    TEST_CHECK(lwshell_set_time_fn(prv_test_time) == lwshellOK);
+    TEST_CHECK(lwshell_set_rate_limit(0, UINT32_MAX) == lwshellERRPAR);
+
+    /* Full burst is available immediately, next command after 1/rate seconds */
+    TEST_CHECK(lwshell_set_rate_limit(0, 2) == lwshellOK);
+    TEST_CHECK(lwshell_input(lines, 9) == lwshellOK);
+    TEST_CHECK(count_calls == 2);
+    test_time += 499;
+    TEST_CHECK(lwshell_process() == lwshellOK);
+    TEST_CHECK(count_calls == 2);
+    test_time += 1;
+    TEST_CHECK(lwshell_process() == lwshellOK);
+    TEST_CHECK(count_calls == 3);
+
+    /* Long idle time refills the burst only up to one second worth of commands */
+    test_time += 10000;
+    TEST_CHECK(lwshell_input(lines, 12) == lwshellOK);
+    TEST_CHECK(count_calls == 5);
+    TEST_CHECK(lwshell_process() == lwshellOK);
+    TEST_CHECK(count_calls == 5);
+    test_time += 500;
+    TEST_CHECK(lwshell_process() == lwshellOK);
+    TEST_CHECK(count_calls == 6);
+    test_time += 500;
+    TEST_CHECK(lwshell_process() == lwshellOK);
+    TEST_CHECK(count_calls == 7);
+
+    /* Bytes limit splits the line, command runs when its line end is processed */
+    TEST_CHECK(lwshell_set_rate_limit(4, 0) == lwshellOK);
+    TEST_CHECK(lwshell_input(lines, 6) == lwshellOK);
+    TEST_CHECK(count_calls == 8);
+    test_time += 250;
+    TEST_CHECK(lwshell_process() == lwshellOK);
+    TEST_CHECK(count_calls == 8);
+    test_time += 250;
+    TEST_CHECK(lwshell_process() == lwshellOK);
+    TEST_CHECK(count_calls == 9);
+    TEST_CHECK(lwshell_get_dropped() == 0);
+
+    /* Data over the queue size is dropped and counted */
+    TEST_CHECK(lwshell_set_rate_limit(1, 0) == lwshellOK);
+    TEST_CHECK(lwshell_input(lines, 12) == lwshellOK);
+    TEST_CHECK(lwshell_input(lines, 9) == lwshellERRMEM);
+    TEST_CHECK(lwshell_get_dropped() == 12U + 9U - 1U - LWSHELL_CFG_RATE_QUEUE_SIZE);
+    TEST_CHECK(lwshell_input(lines, 1) == lwshellERRMEM);
+    TEST_CHECK(lwshell_get_dropped() == 12U + 9U - LWSHELL_CFG_RATE_QUEUE_SIZE);
+    TEST_CHECK(count_calls == 9);
+
+    /* Disabled limits flush the queue, dropped data is lost, 5 complete lines remain */
+    TEST_CHECK(lwshell_set_rate_limit(0, 0) == lwshellOK);
+    TEST_CHECK(count_calls == 14);
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_RATE_LIMIT */
+
+#if LWSHELL_CFG_USE_TRANSCRIPT && LWSHELL_CFG_USE_OUTPUT && LWSHELL_CFG_USE_STATIC_COMMANDS
+
+/* Recorded transcript */
+static uint8_t trans_buff[1024];
+static size_t trans_len;
+
+/**
+ * \brief           Transcript function appending data to the test buffer
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       data: Transcript data
+ * \param[in]       len: Length of data in bytes
+ */
+static void
+prv_trans_collect(lwshell_t* lwobj, const void* data, size_t len) {
+    (void)lwobj;
+    if (trans_len + len <= sizeof(trans_buff)) {
+        memcpy(&trans_buff[trans_len], data, len);
+    }
+    trans_len += len;
+}
+
+/**
+ * \brief           Append output record of short string, without time difference, to expected transcript
+ * \param[in,out]   buff: Expected transcript
+ * \param[in,out]   len: Length of expected transcript
+ * \param[in]       str: Output string, shorter than `128` characters
+ */
+static void
+prv_trans_expect_out(uint8_t* buff, size_t* len, const char* str) {
+    buff[(*len)++] = LWSHELL_TRANSCRIPT_REC_OUTPUT;
+    buff[(*len)++] = 0x00;
+    buff[(*len)++] = (uint8_t)strlen(str);
+    memcpy(&buff[*len], str, strlen(str));
+    *len += strlen(str);
+}
+
+/**
+ * \brief           Record short session and compare it with the documented format
+ * \param[in]       path: File to write transcript to, for replay tool, or `NULL`
+ * \return          Number of failed checks
+ */
+static int
+prv_test_transcript(const char* path) {
+    static const lwshell_cmd_t table[] = {
+        {.name = "st", .desc = "Static", .fn = prv_count_cmd},
+    };
+    /* Header, records of registered commands with flags, name and description, and first input */
+    static const char hdr[] = "LWSH\x01"
+                              "\x03\x00\x09\x00"
+                              "ab\0Test\0"
+                              "\x03\x00\x0B\x01"
+                              "st\0Static\0"
+                              "\x03\xAC\x02\x0B\x00"
+                              "late\0Late\0"
+                              "\x01\x00\x03"
+                              "ab\n";
+    static const char line_ab[] = "ab\n", line_x[] = "x\n", line_list[] = "listcmd\n";
+    uint8_t expected[128];
+    size_t expected_len = sizeof(hdr) - 1, rec_len;
+    int failed = 0;
+
+    prv_shell_init();
+    lwshell_set_output_fn(prv_out_collect);
+    count_calls = 0;
+    trans_len = 0;
+    test_time = 1000;
+    TEST_CHECK(lwshell_set_time_fn(prv_test_time) == lwshellOK);
+    TEST_CHECK(lwshell_register_cmd("ab", prv_count_cmd, "Test") == lwshellOK);
+    TEST_CHECK(lwshell_register_static_cmds(table, LWSHELL_ARRAYSIZE(table)) == lwshellOK);
+
+    /* Commands registered before and during recording, time difference of 300ms takes 2 bytes */
+    TEST_CHECK(lwshell_set_transcript_fn(prv_trans_collect) == lwshellOK);
+    test_time += 300;
+    TEST_CHECK(lwshell_register_cmd("late", prv_count_cmd, "Late") == lwshellOK);
+    lwshell_input(line_ab, sizeof(line_ab) - 1);
+    test_time += 1;
+    lwshell_input(line_x, sizeof(line_x) - 1);
+    lwshell_input(line_list, sizeof(line_list) - 1);
+    TEST_CHECK(lwshell_set_transcript_fn(NULL) == lwshellOK);
+    rec_len = trans_len;
+    lwshell_input(line_ab, sizeof(line_ab) - 1);
+    TEST_CHECK(count_calls == 2);
+    TEST_CHECK(trans_len == rec_len);
+
+    /* Exact records up to listing of commands */
+    memcpy(expected, hdr, expected_len);
+    prv_trans_expect_out(expected, &expected_len, "a");
+    prv_trans_expect_out(expected, &expected_len, "b");
+    prv_trans_expect_out(expected, &expected_len, TEST_ECHO_LF);
+    memcpy(&expected[expected_len], "\x01\x01\x02x\n", 5);
+    expected_len += 5;
+    prv_trans_expect_out(expected, &expected_len, "x");
+    prv_trans_expect_out(expected, &expected_len, TEST_ECHO_LF);
+    prv_trans_expect_out(expected, &expected_len, "Unknown command" LWSHELL_CFG_NEWLINE);
+    memcpy(&expected[expected_len], "\x01\x00\x08listcmd\n", 11);
+    expected_len += 11;
+    TEST_CHECK(trans_len > expected_len && trans_len <= sizeof(trans_buff));
+    TEST_CHECK(memcmp(trans_buff, expected, expected_len) == 0);
+    if (path != NULL) {
+        FILE* f = fopen(path, "wb");
+
+        TEST_CHECK(f != NULL && fwrite(trans_buff, 1, trans_len, f) == trans_len);
+        if (f != NULL) {
+            fclose(f);
+        }
+    }
+    lwshell_set_output_fn(NULL);
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_TRANSCRIPT && LWSHELL_CFG_USE_OUTPUT && LWSHELL_CFG_USE_STATIC_COMMANDS */
+
+#if LWSHELL_CFG_USE_ALLOC && LWSHELL_TEST_ALLOC
+
+/* Allocation failure switch */
+static int alloc_fail;
+
+/**
+ * \brief           Test allocator, failing while failure switch is set
+ * \param[in]       ptr: Memory to reallocate or `NULL`
+ * \param[in]       size: New size in bytes
+ * \return          Pointer to reallocated memory, `NULL` on failure
+ */
+void*
+test_realloc(void* ptr, size_t size) {
+    return alloc_fail ? NULL : realloc(ptr, size);
+}
+
+/* Length of the first argument of the last argument length command call */
+static size_t arg_len;
+
+/**
+ * \brief           Command storing length of its first argument
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ * \return          `0` on success
+ */
+static int32_t
+prv_arg_len_cmd(int32_t argc, char** argv) {
+    arg_len = argc > 1 ? strlen(argv[1]) : 0;
+    return 0;
+}
+
+/**
+ * \brief           Input buffer and commands table grow on demand, failed allocation keeps old state
+ * \return          Number of failed checks
+ */
+static int
+prv_test_alloc(void) {
+    static const char* const names[] = {"c0", "c1", "c2", "c3", "c4"};
+    static const char line_c0[] = "c0\n";
+    static lwshell_t lw;
+    char line[LWSHELL_CFG_MAX_INPUT_LEN + 16];
+    int failed = 0;
+
+    TEST_CHECK(lwshell_init_ex(&lw) == lwshellOK);
+    alloc_fail = 0;
+
+    /* Nothing is allocated before it is needed */
+    TEST_CHECK(lw.buff == NULL && lw.dynamic_cmds == NULL);
+
+    /* Failed first allocation, input is dropped without command */
+    alloc_fail = 1;
+    TEST_CHECK(lwshell_register_cmd_ex(&lw, "c0", prv_arg_len_cmd, NULL) == lwshellERRMEM);
+    lwshell_input_ex(&lw, line_c0, sizeof(line_c0) - 1);
+    TEST_CHECK(lw.buff == NULL && lw.buff_ptr == 0 && lw.dynamic_cmds == NULL);
+    alloc_fail = 0;
+
+    /* Commands table grows from initial size to twice the size */
+    for (size_t idx = 0; idx < LWSHELL_CFG_ALLOC_DYNAMIC_CMDS_INIT; ++idx) {
+        TEST_CHECK(lwshell_register_cmd_ex(&lw, names[idx], prv_arg_len_cmd, NULL) == lwshellOK);
+    }
+    TEST_CHECK(lw.dynamic_cmds_size == LWSHELL_CFG_ALLOC_DYNAMIC_CMDS_INIT);
+    alloc_fail = 1;
+    TEST_CHECK(lwshell_register_cmd_ex(&lw, names[4], prv_arg_len_cmd, NULL) == lwshellERRMEM);
+    TEST_CHECK(lw.dynamic_cmds_size == LWSHELL_CFG_ALLOC_DYNAMIC_CMDS_INIT);
+    TEST_CHECK(lw.dynamic_cmds_cnt == LWSHELL_CFG_ALLOC_DYNAMIC_CMDS_INIT);
+    alloc_fail = 0;
+    TEST_CHECK(lwshell_register_cmd_ex(&lw, names[4], prv_arg_len_cmd, NULL) == lwshellOK);
+    TEST_CHECK(lw.dynamic_cmds_size == 2 * LWSHELL_CFG_ALLOC_DYNAMIC_CMDS_INIT);
+    TEST_CHECK(strcmp(lw.dynamic_cmds[0].name, "c0") == 0 && strcmp(lw.dynamic_cmds[4].name, "c4") == 0);
+
+    /* Input buffer grows up to the maximal line length */
+    memset(line, 'x', sizeof(line));
+    memcpy(line, "c0 ", 3);
+    line[LWSHELL_CFG_ALLOC_INPUT_LEN_INIT + 8] = '\n';
+    lwshell_input_ex(&lw, line, LWSHELL_CFG_ALLOC_INPUT_LEN_INIT + 9);
+    TEST_CHECK(lw.buff_size == 2 * (LWSHELL_CFG_ALLOC_INPUT_LEN_INIT + 1));
+    TEST_CHECK(arg_len == LWSHELL_CFG_ALLOC_INPUT_LEN_INIT + 5);
+    line[LWSHELL_CFG_ALLOC_INPUT_LEN_INIT + 8] = 'x';
+    line[sizeof(line) - 1] = '\n';
+    lwshell_input_ex(&lw, line, sizeof(line));
+    TEST_CHECK(lw.buff_size == LWSHELL_CFG_MAX_INPUT_LEN + 1);
+    TEST_CHECK(arg_len == LWSHELL_CFG_MAX_INPUT_LEN - 3);
+
+    /* Failed growth truncates the line, characters stored so far are kept */
+    lwshell_deinit_ex(&lw);
+    TEST_CHECK(lwshell_register_cmd_ex(&lw, "c0", prv_arg_len_cmd, NULL) == lwshellOK);
+    lwshell_input_ex(&lw, line, 3);
+    TEST_CHECK(lw.buff_size == LWSHELL_CFG_ALLOC_INPUT_LEN_INIT + 1);
+    alloc_fail = 1;
+    line[sizeof(line) - 1] = 'x';
+    line[LWSHELL_CFG_ALLOC_INPUT_LEN_INIT + 8] = '\n';
+    lwshell_input_ex(&lw, &line[3], LWSHELL_CFG_ALLOC_INPUT_LEN_INIT + 6);
+    TEST_CHECK(lw.buff_size == LWSHELL_CFG_ALLOC_INPUT_LEN_INIT + 1);
+    TEST_CHECK(arg_len == LWSHELL_CFG_ALLOC_INPUT_LEN_INIT - 3);
+#if LWSHELL_CFG_USE_RESULT
+    TEST_CHECK(lw.result.flags == LWSHELL_RESULT_FLAG_TRUNCATED);
+#endif /* LWSHELL_CFG_USE_RESULT */
+    alloc_fail = 0;
+    lwshell_deinit_ex(&lw);
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_ALLOC && LWSHELL_TEST_ALLOC */
+
+#if LWSHELL_CFG_USE_PAYLOAD
+
+/* Payload received by payload command, number of chunks and command calls */
+static char payload_buff[64];
+static int payload_chunks;
+static int payload_cmd_calls;
+static int32_t payload_cmd_argc;
+
+/**
+ * \brief           Payload command, called at the end of payload line
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ * \return          `0` on success
+ */
+static int32_t
+prv_payload_cmd(int32_t argc, char** argv) {
+    (void)argv;
+    ++payload_cmd_calls;
+    payload_cmd_argc = argc;
+    return 0;
+}
+
+/**
+ * \brief           Append payload chunk to the test buffer
+ * \param[in]       lwobj: LwSHELL instance
+ * \param[in]       data: Payload data chunk
+ * \param[in]       len: Length of payload data chunk in bytes
+ */
+static void
+prv_payload_collect(lwshell_t* lwobj, const char* data, size_t len) {
+    size_t cur = strlen(payload_buff);
+
+    (void)lwobj;
+    ++payload_chunks;
+    if (cur + len < sizeof(payload_buff)) {
+        memcpy(&payload_buff[cur], data, len);
+        payload_buff[cur + len] = '\0';
+    }
+}
+
+/**
+ * \brief           Payload is streamed in chunks until end of line, next line is processed normally
+ * \return          Number of failed checks
+ */
+static int
+prv_test_payload(void) {
+    int failed = 0;
+
+    prv_shell_init();
+    payload_buff[0] = '\0';
+    payload_chunks = 0;
+    payload_cmd_calls = 0;
+    count_calls = 0;
+    TEST_CHECK(lwshell_register_payload_cmd("up", prv_payload_cmd, prv_payload_collect, "Payload") == lwshellOK);
+    TEST_CHECK(lwshell_register_cmd("cnt", prv_count_cmd, "Counter") == lwshellOK);
+
+    /* One chunk per input call, command runs once at the end of payload */
+    lwshell_input("up ", 3);
+    lwshell_input("a$b", 3);
+    lwshell_input(" \"c", 3);
+    TEST_CHECK(strcmp(payload_buff, "a$b \"c") == 0);
+    TEST_CHECK(payload_chunks == 2);
+    TEST_CHECK(payload_cmd_calls == 0);
+    lwshell_input("d\ncnt x\n", 8);
+    TEST_CHECK(strcmp(payload_buff, "a$b \"cd") == 0);
+    TEST_CHECK(payload_chunks == 3);
+    TEST_CHECK(payload_cmd_calls == 1 && payload_cmd_argc == 1);
+    TEST_CHECK(count_calls == 1);
+
+    /* Payload and line end in the same call, leading spaces before command name */
+    payload_buff[0] = '\0';
+    lwshell_input("  up 1 2\r", 9);
+    TEST_CHECK(strcmp(payload_buff, "1 2") == 0);
+    TEST_CHECK(payload_chunks == 4);
+    TEST_CHECK(payload_cmd_calls == 2);
+
+    /* Payload starts only after command name, not with other commands or without space */
+    payload_buff[0] = '\0';
+    lwshell_input("\nup\ncnt up 1\nupx 1\n", 20);
+    TEST_CHECK(payload_buff[0] == '\0' && payload_chunks == 4);
+    TEST_CHECK(payload_cmd_calls == 3);
+    TEST_CHECK(count_calls == 2);
+
+#if LWSHELL_CFG_USE_ALLOC && LWSHELL_TEST_ALLOC
+    /* Space as the first character, when input buffer could not be allocated */
+    lwshell_deinit();
+    TEST_CHECK(lwshell_register_payload_cmd("up", prv_payload_cmd, prv_payload_collect, "Payload") == lwshellOK);
+    alloc_fail = 1;
+    lwshell_input(" up 1\n", 6);
+    alloc_fail = 0;
+    TEST_CHECK(payload_chunks == 4 && payload_cmd_calls == 3);
+#endif /* LWSHELL_CFG_USE_ALLOC && LWSHELL_TEST_ALLOC */
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_PAYLOAD */
+
+#if LWSHELL_CFG_USE_VARS
+
+/**
+ * \brief           Overwrite of variable that does not fit to the arena keeps old value
+ * \return          Number of failed checks
+ */
+static int
+prv_test_var_overwrite(void) {
+    char value[LWSHELL_CFG_VARS_ARENA_SIZE];
+    int failed = 0;
+
+    prv_shell_init();
+    memset(value, 'x', sizeof(value));
+    value[70] = '\0';
+    TEST_CHECK(lwshell_set_var("a", value) == lwshellOK);
+    TEST_CHECK(lwshell_set_var("b", "short") == lwshellOK);
+
+    /* New value does not fit, even with the old one removed */
+    value[70] = 'x';
+    value[80] = '\0';
+    TEST_CHECK(lwshell_set_var("b", value) == lwshellERRMEM);
+    TEST_CHECK(lwshell_get_var("b") != NULL && strcmp(lwshell_get_var("b"), "short") == 0);
+    TEST_CHECK(lwshell_get_var("a") != NULL && strlen(lwshell_get_var("a")) == 70);
+
+    /* New value fits only when the old one is removed first */
+    value[40] = '\0';
+    TEST_CHECK(lwshell_set_var("b", value) == lwshellOK);
+    TEST_CHECK(lwshell_get_var("b") != NULL && strcmp(lwshell_get_var("b"), value) == 0);
+
+    /* Value from the arena needs space for both copies */
+    TEST_CHECK(lwshell_set_var("b", lwshell_get_var("a")) == lwshellERRMEM);
+    TEST_CHECK(lwshell_get_var("b") != NULL && strcmp(lwshell_get_var("b"), value) == 0);
+    TEST_CHECK(lwshell_set_var("b", "hi") == lwshellOK);
+    TEST_CHECK(lwshell_set_var("b", lwshell_get_var("b")) == lwshellOK);
+    TEST_CHECK(lwshell_get_var("b") != NULL && strcmp(lwshell_get_var("b"), "hi") == 0);
+    return failed;
+}
+
+/* Arguments received by the last call of argument copying command */
+static char args_seen[LWSHELL_CFG_MAX_CMD_ARGS][16];
+static int32_t args_seen_cnt;
+
+/**
+ * \brief           Command copying its arguments
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ * \return          `0` on success
+ */
+static int32_t
+prv_args_cmd(int32_t argc, char** argv) {
+    args_seen_cnt = argc;
+    for (int32_t idx = 0; idx < argc; ++idx) {
+        strncpy(args_seen[idx], argv[idx], sizeof(args_seen[idx]) - 1);
+        args_seen[idx][sizeof(args_seen[idx]) - 1] = '\0';
+    }
+    return 0;
+}
+
+/**
+ * \brief           Only whole unquoted `$name` arguments are expanded
+ * \return          Number of failed checks
+ */
+static int
+prv_test_var_expand(void) {
+    static const char line[] = "args $a x$a $a$a $a. \"$a\" $b\n";
+    static const char* const expected[] = {"args", "1", "x$a", "$a$a", "$a.", "$a", "$b"};
+    int failed = 0;
+
+    prv_shell_init();
+    args_seen_cnt = 0;
+    TEST_CHECK(lwshell_register_cmd("args", prv_args_cmd, "Arguments") == lwshellOK);
+    TEST_CHECK(lwshell_set_var("a", "1") == lwshellOK);
+    lwshell_input(line, sizeof(line) - 1);
+    TEST_CHECK(args_seen_cnt == (int32_t)LWSHELL_ARRAYSIZE(expected));
+    for (size_t idx = 0; idx < LWSHELL_ARRAYSIZE(expected) && idx < (size_t)args_seen_cnt; ++idx) {
+        TEST_CHECK(strcmp(args_seen[idx], expected[idx]) == 0);
+    }
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_VARS */
+
+#if LWSHELL_CFG_USE_ALIAS
+
+/* Number of calls and last result of alias change from the command */
+static int alias_cmd_calls;
+static lwshellr_t alias_cmd_res;
+
+/**
+ * \brief           Command deleting alias it is executed from
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ * \return          `0` on success
+ */
+static int32_t
+prv_alias_delete_cmd(int32_t argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    ++alias_cmd_calls;
+    alias_cmd_res = lwshell_set_alias("m", NULL);
+    return 0;
+}
+
+/**
+ * \brief           Aliases cannot be changed while an alias is executing
+ * \return          Number of failed checks
+ */
+static int
+prv_test_alias_locked(void) {
+    static const char line[] = "m\n";
+    int failed = 0;
+
+    prv_shell_init();
+    TEST_CHECK(lwshell_register_cmd("del", prv_alias_delete_cmd, NULL) == lwshellOK);
+    TEST_CHECK(lwshell_set_alias("m", "del first; del second") == lwshellOK);
+    lwshell_input(line, sizeof(line) - 1);
+    TEST_CHECK(alias_cmd_calls == 2);
+    TEST_CHECK(alias_cmd_res == lwshellERR);
+
+    /* Alias still exists and can be deleted outside of execution */
+    alias_cmd_res = lwshellOK;
+    lwshell_input(line, sizeof(line) - 1);
+    TEST_CHECK(alias_cmd_calls == 4);
+    TEST_CHECK(lwshell_set_alias("m", NULL) == lwshellOK);
+    return failed;
+}
+
+/**
+ * \brief           Aliases cannot shadow built-in or registered commands
+ * \return          Number of failed checks
+ */
+static int
+prv_test_alias_reserved(void) {
+    static const char def_line[] = "alias alias status -v\n";
+    static const char list_line[] = "alias\n";
+    static const char later_line[] = "later\n";
+    int failed = 0;
+
+    prv_shell_init();
+    count_calls = 0;
+    TEST_CHECK(lwshell_register_cmd("status", prv_count_cmd, NULL) == lwshellOK);
+    TEST_CHECK(lwshell_set_alias("alias", "status -v") == lwshellERRPAR);
+    TEST_CHECK(lwshell_set_alias("set", "status") == lwshellERRPAR);
+    TEST_CHECK(lwshell_set_alias("login", "status") == lwshellERRPAR);
+    TEST_CHECK(lwshell_set_alias("listcmd", "status") == lwshellERRPAR);
+    TEST_CHECK(lwshell_set_alias("status", "status -v") == lwshellERRPAR);
+
+    /* Built-in stays available after failed attempt from the shell */
+    lwshell_input(def_line, sizeof(def_line) - 1);
+    lwshell_input(list_line, sizeof(list_line) - 1);
+    TEST_CHECK(count_calls == 0);
+
+#if LWSHELL_CFG_USE_PERMISSIONS
+    /* Command the session cannot run is reserved too */
+    TEST_CHECK(lwshell_register_cmd("wipe", prv_count_cmd, NULL) == lwshellOK);
+    TEST_CHECK(lwshell_set_cmd_perm("wipe", 0x01) == lwshellOK);
+    TEST_CHECK(lwshell_set_alias("wipe", "status") == lwshellERRPAR);
+#endif /* LWSHELL_CFG_USE_PERMISSIONS */
+
+    /* Command registered later takes precedence, alias can still be deleted */
+    TEST_CHECK(lwshell_set_alias("later", "status -v") == lwshellOK);
+    TEST_CHECK(lwshell_register_cmd("later", prv_count_cmd, NULL) == lwshellOK);
+    lwshell_input(later_line, sizeof(later_line) - 1);
+    TEST_CHECK(count_calls == 1);
+    TEST_CHECK(lwshell_set_alias("later", NULL) == lwshellOK);
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_ALIAS */
+
+#if LWSHELL_CFG_USE_ALIAS && LWSHELL_CFG_USE_STATIC_COMMANDS
+
+static int static_b_calls;
+
+static int32_t
+prv_static_a_cmd(int32_t argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    return 0;
+}
+
+static int32_t
+prv_static_b_cmd(int32_t argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    ++static_b_calls;
+    return 0;
+}
+
+/**
+ * \brief           Alias runs command by name after static table is replaced
+ * \return          Number of failed checks
+ */
+static int
+prv_test_alias_static_replace(void) {
+    static const lwshell_cmd_t table_ab[] = {
+        {.name = "a", .fn = prv_static_a_cmd},
+        {.name = "b", .fn = prv_static_b_cmd},
+    };
+    static const lwshell_cmd_t table_ba[] = {
+        {.name = "b", .fn = prv_static_b_cmd},
+        {.name = "a", .fn = prv_static_a_cmd},
+    };
+    static const lwshell_cmd_t table_a[] = {
+        {.name = "a", .fn = prv_static_a_cmd},
+    };
+    static const char line[] = "m\n";
+    int failed = 0;
+
+    prv_shell_init();
+    static_b_calls = 0;
+    TEST_CHECK(lwshell_register_static_cmds(table_ab, LWSHELL_ARRAYSIZE(table_ab)) == lwshellOK);
+    TEST_CHECK(lwshell_set_alias("m", "b") == lwshellOK);
+    TEST_CHECK(lwshell_register_static_cmds(table_ba, LWSHELL_ARRAYSIZE(table_ba)) == lwshellOK);
+    lwshell_input(line, sizeof(line) - 1);
+    TEST_CHECK(static_b_calls == 1);
+
+    /* Command removed from the table is not run anymore */
+    TEST_CHECK(lwshell_register_static_cmds(table_a, LWSHELL_ARRAYSIZE(table_a)) == lwshellOK);
+    lwshell_input(line, sizeof(line) - 1);
+    TEST_CHECK(static_b_calls == 1);
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_ALIAS && LWSHELL_CFG_USE_STATIC_COMMANDS */
+
+#if LWSHELL_CFG_USE_ALIAS && LWSHELL_CFG_USE_PERMISSIONS && LWSHELL_CFG_USE_OUTPUT
+
+/**
+ * \brief           Aliases with privileged commands are not listed to sessions without permission
+ * \return          Number of failed checks
+ */
+static int
+prv_test_alias_perm_list(void) {
+    static const char line[] = "alias\n";
+    int failed = 0;
+
+    prv_shell_init();
+    lwshell_set_output_fn(prv_out_collect);
+    TEST_CHECK(lwshell_register_cmd("wipe", prv_count_cmd, NULL) == lwshellOK);
+    TEST_CHECK(lwshell_set_cmd_perm("wipe", 0x80000000UL) == lwshellOK);
+    TEST_CHECK(lwshell_set_perm(0x80000000UL) == lwshellOK);
+    TEST_CHECK(lwshell_get_perm() == 0x80000000UL);
+    TEST_CHECK(lwshell_set_alias("w", "wipe all") == lwshellOK);
+
+    out_buff[0] = '\0';
+    lwshell_input(line, sizeof(line) - 1);
+    TEST_CHECK(strstr(out_buff, "wipe all") != NULL);
+
+    /* Session without permission does not see the alias */
+    TEST_CHECK(lwshell_set_perm(0) == lwshellOK);
+    out_buff[0] = '\0';
+    lwshell_input(line, sizeof(line) - 1);
+    TEST_CHECK(strstr(out_buff, "wipe") == NULL);
+    lwshell_set_output_fn(NULL);
+    TEST_CHECK(lwshell_set_alias("w", NULL) == lwshellOK);
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_ALIAS && LWSHELL_CFG_USE_PERMISSIONS && LWSHELL_CFG_USE_OUTPUT */
+
+#if LWSHELL_CFG_USE_PRINTF && !LWSHELL_CFG_PRINTF_FLOAT
+
+/**
+ * \brief           Floating point value is replaced by placeholder when float support is disabled
+ * \return          Number of failed checks
+ */
+static int
+prv_test_printf_no_float(void) {
+    int failed = 0;
+
+    prv_shell_init();
+    lwshell_set_output_fn(prv_out_collect);
+    out_buff[0] = '\0';
+    TEST_CHECK(lwshell_printf("[%5.1f|%-3f|%d]", 2.5, 1.0, 7) == 13);
+    TEST_CHECK(strcmp(out_buff, "[    ?|?  |7]") == 0);
+    lwshell_set_output_fn(NULL);
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_PRINTF && !LWSHELL_CFG_PRINTF_FLOAT */
+
+#if LWSHELL_CFG_USE_PRINTF && LWSHELL_CFG_PRINTF_FLOAT
+
+/* Print with the shell and compare to expected string */
+#define TEST_PRINTF(expected, ...)                                                                                     \
+    do {                                                                                                               \
+        out_buff[0] = '\0';                                                                                            \
+        TEST_CHECK(lwshell_printf(__VA_ARGS__) == strlen(expected));                                                   \
+        TEST_CHECK(strcmp(out_buff, (expected)) == 0);                                                                 \
+    } while (0)
+
+/**
+ * \brief           Floating point values are formatted as libc does
+ * \return          Number of failed checks
+ */
+static int
+prv_test_printf_float(void) {
+    int failed = 0;
+
+    prv_shell_init();
+    lwshell_set_output_fn(prv_out_collect);
+
+    /* Rounding to nearest, exact ties to even digit */
+    TEST_PRINTF("[2.2|0.12|2.67|0|2|2]", "[%.1f|%.2f|%.2f|%.0f|%.0f|%.0f]", 2.25, 0.125, 2.675, 0.5, 1.5, 2.5);
+    TEST_PRINTF("[0.100000000000000|0.333333333333]", "[%.15f|%.12f]", 0.1, 1.0 / 3);
+
+    /* Negative values and sign flags */
+    TEST_PRINTF("[-1.000|-0.100000|-2.35|+3.0| 3.0]", "[%.3f|%f|%.2f|%+.1f|% .1f]", -1.0005, -0.1, -2.345, 3.05, 3.05);
+
+    /* Width and precision */
+    TEST_PRINTF("[   3.142|3.14    |-0003.14|   1.00]", "[%8.3f|%-8.2f|%+08.2f|%*.*f]", 3.14159, 3.14159, -3.14159,
+                7, 2, 1.005);
+    TEST_PRINTF("[?|  ?]", "[%.16f|%3.20f]", 1.5, 1.5);
+
+    /* Special values are never zero padded */
+    TEST_PRINTF("[  inf|-inf |  nan|+inf]", "[%5f|%-5f|%05f|%+f]", (double)INFINITY, -(double)INFINITY, (double)NAN,
+                (double)INFINITY);
+
+    /* Values too large for integer type */
+    TEST_PRINTF("[100000000000000000000.0|-18446744073709551616]", "[%.1f|%.0f]", 1e20, -18446744073709551616.0);
+    TEST_PRINTF("[1180591620717411303424.0]", "[%.1f]", 1180591620717411303424.0);
+    out_buff[0] = '\0';
+    TEST_CHECK(lwshell_printf("%.2f", DBL_MAX) == 312);
+    TEST_CHECK(strncmp(out_buff, "17976931348623157081", 20) == 0 && strcmp(&out_buff[309], ".00") == 0);
+    lwshell_set_output_fn(NULL);
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_PRINTF && LWSHELL_CFG_PRINTF_FLOAT */
+
+#if LWSHELL_CFG_USE_PRINTF || LWSHELL_CFG_USE_STRUCTURED_OUTPUT
+
+/* Instance seen by the command function */
+static lwshell_t* current_seen;
+
+/**
+ * \brief           Command storing instance it is executed from
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Pointer to arguments
+ * \return          `0` on success
+ */
+static int32_t
+prv_current_cmd(int32_t argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    current_seen = lwshell_get_current_ex();
+    return 0;
+}
+
+/**
+ * \brief           Instance executing command is reported only during command function
+ * \return          Number of failed checks
+ */
+static int
+prv_test_current(void) {
+    static const char line[] = "cur\n";
+    static lwshell_t lw;
+    int failed = 0;
+
+    TEST_CHECK(lwshell_init_ex(&lw) == lwshellOK);
+    TEST_CHECK(lwshell_register_cmd_ex(&lw, "cur", prv_current_cmd, NULL) == lwshellOK);
+    lwshell_input_ex(&lw, line, sizeof(line) - 1);
+    TEST_CHECK(current_seen == &lw);
+    TEST_CHECK(lwshell_get_current_ex() == NULL);
+#if LWSHELL_CFG_USE_ALLOC
+    lwshell_deinit_ex(&lw);
+#endif /* LWSHELL_CFG_USE_ALLOC */
+    return failed;
+}
+
+#endif /* LWSHELL_CFG_USE_PRINTF || LWSHELL_CFG_USE_STRUCTURED_OUTPUT */
+
+/**
+ * \brief           Program entry point
+ * \param[in]       argc: Number of arguments
+ * \param[in]       argv: Arguments, optional file to write recorded transcript to
+ * \return          `0` when all checks pass, `1` otherwise
+ */
+int
+main(int argc, char** argv) {
+    int failed = 0;
+
+    (void)argc;
+    (void)argv;
+#if LWSHELL_CFG_USE_OUTPUT
+    failed += prv_test_line_ends();
+#endif /* LWSHELL_CFG_USE_OUTPUT */
+#if LWSHELL_CFG_USE_ECHO_MODE && LWSHELL_CFG_USE_OUTPUT
+    failed += prv_test_echo_modes();
+#endif /* LWSHELL_CFG_USE_ECHO_MODE && LWSHELL_CFG_USE_OUTPUT */
+#if LWSHELL_CFG_USE_STRUCTURED_OUTPUT && LWSHELL_CFG_USE_OUTPUT
+    failed += prv_test_structured();
+#endif /* LWSHELL_CFG_USE_STRUCTURED_OUTPUT && LWSHELL_CFG_USE_OUTPUT */
+#if LWSHELL_CFG_USE_RESULT
+    failed += prv_test_result();
+#endif /* LWSHELL_CFG_USE_RESULT */
+#if LWSHELL_CFG_USE_RATE_LIMIT
+    failed += prv_test_rate_limit();
+#endif /* LWSHELL_CFG_USE_RATE_LIMIT */
+#if LWSHELL_CFG_USE_TRANSCRIPT && LWSHELL_CFG_USE_OUTPUT && LWSHELL_CFG_USE_STATIC_COMMANDS
+    failed += prv_test_transcript(argc > 1 ? argv[1] : NULL);
+#endif /* LWSHELL_CFG_USE_TRANSCRIPT && LWSHELL_CFG_USE_OUTPUT && LWSHELL_CFG_USE_STATIC_COMMANDS */
+#if LWSHELL_CFG_USE_ALLOC && LWSHELL_TEST_ALLOC
+    failed += prv_test_alloc();
+#endif /* LWSHELL_CFG_USE_ALLOC && LWSHELL_TEST_ALLOC */
+#if LWSHELL_CFG_USE_PAYLOAD
+    failed += prv_test_payload();
+#endif /* LWSHELL_CFG_USE_PAYLOAD */
+#if LWSHELL_CFG_USE_VARS
+    failed += prv_test_var_overwrite();
+    failed += prv_test_var_expand();
+#endif /* LWSHELL_CFG_USE_VARS */
+#if LWSHELL_CFG_USE_ALIAS
+    failed += prv_test_alias_locked();
+    failed += prv_test_alias_reserved();
+#endif /* LWSHELL_CFG_USE_ALIAS */
+#if LWSHELL_CFG_USE_ALIAS && LWSHELL_CFG_USE_STATIC_COMMANDS
+    failed += prv_test_alias_static_replace();
+#endif /* LWSHELL_CFG_USE_ALIAS && LWSHELL_CFG_USE_STATIC_COMMANDS */
+#if LWSHELL_CFG_USE_ALIAS && LWSHELL_CFG_USE_PERMISSIONS && LWSHELL_CFG_USE_OUTPUT
+    failed += prv_test_alias_perm_list();
+#endif /* LWSHELL_CFG_USE_ALIAS && LWSHELL_CFG_USE_PERMISSIONS && LWSHELL_CFG_USE_OUTPUT */
+#if LWSHELL_CFG_USE_PRINTF && !LWSHELL_CFG_PRINTF_FLOAT
+    failed += prv_test_printf_no_float();
+#endif /* LWSHELL_CFG_USE_PRINTF && !LWSHELL_CFG_PRINTF_FLOAT */
+#if LWSHELL_CFG_USE_PRINTF && LWSHELL_CFG_PRINTF_FLOAT
+    failed += prv_test_printf_float();
+#endif /* LWSHELL_CFG_USE_PRINTF && LWSHELL_CFG_PRINTF_FLOAT */
+#if LWSHELL_CFG_USE_PRINTF || LWSHELL_CFG_USE_STRUCTURED_OUTPUT
+    failed += prv_test_current();
+#endif /* LWSHELL_CFG_USE_PRINTF || LWSHELL_CFG_USE_STRUCTURED_OUTPUT */
+
+#if LWSHELL_CFG_USE_ALLOC
+    lwshell_deinit();
+#endif /* LWSHELL_CFG_USE_ALLOC */
+    printf("%d checks failed\n", failed);
+    return failed > 0 ? 1 : 0;
+}